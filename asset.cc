@@ -62,6 +62,31 @@ the state variable uses. If a state variable uses b bits, then its value is an
 integer in the range 0, ..., 2^b-1. Its initial value is 0. The default number
 of bits is 8.
 
+Arrays of state variables of the same size may be declared via the
+pre-defined type state_array. The declaration "state_array< n, b > a" creates
+an array of n cells of b bits each, packed into words of their own. a[ i ] is
+used like a state variable. Furthermore, the following operations process the
+array a word at a time: a.find_nonzero( i ) and a.find_zero( i ) return the
+index of the first non-zero or zero cell at or after i (or n if there is
+none), a.is_zero() tells whether all cells are 0, a.fill( v ) sets every cell
+to v, a.shift_down() moves the contents one cell towards index 0 (cell n-1
+becomes 0), a.shift_up() moves it one cell towards index n-1 (cell 0 becomes
+0), a.remove( i ) removes cell i by moving the cells after it one step down,
+and a == b compares two arrays of the same type.
+
+Bounded first-in first-out channels may be represented via the pre-defined
+type channel. The declaration "channel ch( c, b )" creates a channel that can
+hold at most c messages of b bits each. Its current length is a state
+variable of its own, and its messages are packed in the order of arrival into
+words of their own. The channel is always kept in a canonical form, that is,
+unused message bits are 0, so the model need not compact it. The operations
+are ch.length(), ch.empty(), ch.full(), ch[ i ] (the message at position i,
+the first one is at 0), ch.peek() (the same as ch[ 0 ]), ch.send( m ) (returns
+false if the channel is full, otherwise adds m to the end), ch.receive()
+(removes and returns the first message), ch.lose( i ) (removes and returns
+the message at position i), and ch.clear(). They work on whole words instead
+of individual messages.
+
 The model must provide the following features.
 
   unsigned nr_transitions()
@@ -126,6 +151,89 @@ Not making a call indicates that additional transitions need not be taken. It
 is equivalent to the call stb(). In the case of stb( t1, t2, t3 ), it does not
 matter whether tr itself is in the list.
 
+  #define chk_props
+Lets the model register any number of named properties of each kind, by
+calling the following functions in nr_transitions():
+  prop_state( "name", f )     // const char *f(), like check_state()
+  prop_deadlock( "name", f )  // const char *f(), like check_deadlock()
+  prop_may( "name", f )       // bool f(), like is_may_progress()
+  prop_must( "name", f )      // bool f(), like is_must_progress()
+Unlike the errors detected by the functions above, the violation of a
+registered property does not stop the analysis. All registered properties are
+checked in the same run, the incoming edges are constructed only once for all
+of them, and each violated property is reported with its own counterexample.
+The options dl_not_may and dl_not_must apply also to registered properties.
+
+  #define tr_vars
+  void transition_vars( unsigned tr )
+Used with the options tr_cache and symbolic. Declares the state variables
+that transition tr reads, by calling rd( x ), and those that it may change, by
+calling wr( x ). x may be a state variable, a cell a[ i ] of a state array, a
+whole state array, or a channel. A written variable need not also be declared
+read. Enabledness and the effect of tr must depend only on the declared
+variables. If nothing is declared for tr, its results are not cached, and
+symbolic treats it as depending on the whole state. The function is called
+once for each transition, in the initial state.
+
+  #define state_vars
+  void check_state_vars()
+Used with the option symbolic. Declares the state variables that check_state
+reads, by calling rd( x ). If it is not given, check_state is called in each
+reachable state.
+
+  #define visible_tr
+  bool is_visible( unsigned tr )
+Used with the option minimize. Tells whether transition tr is visible, that
+is, whether the minimization must preserve it. By default, all transitions
+are invisible, because the progress checks only look at states.
+
+  #define components
+  unsigned nr_components()
+  unsigned nr_actions()
+  bool uses_action( unsigned cp, unsigned act )
+  unsigned nr_local( unsigned cp )
+  bool fire_local( unsigned cp, unsigned tr, unsigned &act )
+  bool local_final( unsigned cp )
+  void print_action( unsigned act )
+Switches on compositional verification. The model is described as
+components 0, ..., nr_components()-1 that communicate only via actions 1,
+..., nr_actions()-1. uses_action tells whether action act is in the alphabet
+of component cp. Component cp has local transitions 0, ..., nr_local( cp )-1.
+fire_local is like fire_transition, but it may only change the variables of
+component cp, and it puts in act the action of the transition, or 0 if the
+transition is internal to the component. A transition with an action of the
+alphabets of several components can only occur in all of them at the same
+time. local_final tells whether the component may terminate in the current
+state. The local state space of each component is constructed alone, reduced
+with branching bisimulation, and composed with the others one at a time, so
+the full state space need not be constructed. Instead of check_state,
+check_deadlock, is_may_progress, and is_must_progress, it is checked that
+the system does not stop unless every component may terminate (if
+chk_deadlock is defined), and the following actions are treated as progress:
+  bool is_may_action( unsigned act )    // if chk_may_progress is defined
+  bool is_must_action( unsigned act )   // if chk_must_progress is defined
+A counterexample consists of the actions that stay visible to the end, that
+is, the progress actions and the termination of the whole system.
+The options that concern the construction of the full state space have no
+effect. chk_props and chk_state are not supported, and model checking does
+not start if either is defined.
+
+  #define backward
+  bool fire_backward( unsigned tr )
+  bool next_goal( unsigned gi )
+Used with the option bidirectional. fire_backward is like fire_transition,
+but it changes the current state to a state from which transition tr leads to
+it, if there is one. If there may be several, the transition must be split
+in the model. next_goal changes the current state, which is a copy of the
+initial state, to goal state number gi, and returns false if there is no such
+state. Each goal state must be rejected by check_state.
+
+  #define heuristic
+  unsigned distance()
+Used with the options best_first, a_star, and beam_width. Estimates how many
+transitions are needed to get from the current state to an error. Smaller
+values make the state be investigated sooner. The estimate need not be exact.
+
 The model may also declare an error by making "err_msg" contain a character
 string. The stubborn set method is not guaranteed to find such errors.
 
@@ -149,35 +257,252 @@ or compile-time options:
   stop_cnt      Aborts state space construction after this many states.
   no_sanity_chk Sanity checks that catch modelling bugs are switched off in
                 the most speed-critical parts of ASSET.
+  warm_up       With tr_cache, its sanity checks are made only when
+                investigating the first this many states, that is, the first
+                breadth-first levels. The rest of the states are
+                investigated with a copy of the firing code compiled
+                without them. The range checks of the assignments in the
+                model are made in all states, because the model is compiled
+                only once.
+  warm_sample   With warm_up, the sanity checks are also made in one
+                pseudo-randomly chosen state out of this many after the
+                warm-up.
+  profile       The time spent in the functions of the model is measured per
+                transition, and this many rows of the most expensive
+                transitions are printed at the end. The columns are the
+                share of the total time, the numbers of enabled and disabled
+                firings, and clock ticks per call of fire_transition and
+                next_stubborn, and per new state of check_state and per
+                enabled firing of symmetry_representative. The times are
+                estimated from a sample of one in 16 calls.
   no_progr_chk  Non-progress detection is not executed. Saves memory.
   hash_count    Number of bits used for indexing the hash table.
   size_par      Number that is shown in the analysis results, if no_show_cnt.
+  save_file     Name of a file (as a string literal) to which the constructed
+                state space is saved, for resuming with load_file. Saving
+                takes place when construction stops because of stop_cnt, and
+                after the construction of incoming edges. Construction stops
+                before a state whose investigation might exceed stop_cnt, so
+                stop_cnt must be bigger than the number of transitions.
+  load_file     Name of a file saved with save_file. The state space is taken
+                from it instead of constructing it from scratch. If the saved
+                construction was stopped by stop_cnt, it is continued. The
+                model may be changed in between, as long as the layout of its
+                state variables and its number of transitions stay the same.
+  prev_file     Name of a temporary file in which the finding predecessors of
+                the states are kept, to save main memory. Printing
+                counterexamples becomes slow.
+  lts_file      Name of a file to which the states and edges are written
+                during construction, in a compact binary format (see "Export
+                of the state space" below). The state space is written as it
+                is found, so it need not fit in memory for this. Cannot be
+                used with load_file, whose states would be missing.
+  aut_file      Like lts_file, but the edges are written in the Aldebaran
+                .aut text format, with transition tr labelled "ttr".
+  lts_input     Name of a file written with lts_file. The state space is read
+                from it instead of constructing it, and the progress checks
+                are run on it. The safety and deadlock checks are not
+                repeated. The model must have the same state variables and
+                transitions as when the file was written.
+  minimize      Before the progress checks, the state space is reduced with
+                divergence-sensitive branching bisimulation that preserves
+                the visible transitions, the terminal states, and the
+                progress states of each progress check. Each progress check
+                is first made on the reduced state space. Only if it fails,
+                it is repeated on the full state space for the
+                counterexample.
+  mem_budget    Memory budget in megabytes. The size of the hash table and the
+                maximum number of states are chosen from it, unless given by
+                hash_count or stop_cnt, and the memory use of the process is
+                watched during construction. If the progress checks would not
+                fit in the budget, they are dropped. With stubborn, this also
+                drops the termination check that the safety checks rely on.
+                When the maximum number of states is reached, it is raised as
+                far as the remaining memory allows. When that does not help,
+                the states that have already been investigated are packed by
+                dropping their unused bits, and then replaced by 32-bit
+                signatures (hash compaction, which may miss states). This is
+                not done with save_file, estimate, best_first, a_star,
+                beam_width, bidirectional, components, symbolic, lts_input, or
+                only_typical. If the budget still runs out, construction is
+                stopped between states, like with stop_cnt. The results then
+                tell which guarantees remain. If checks were dropped or states
+                may have been missed, a warning is printed and the exit status
+                is 1.
+  tr_cache      Number of bits used for indexing the table of the results of
+                each transition. Requires tr_vars. The result of firing a
+                transition is stored under the values of its declared
+                variables, and when the transition is tried again with the
+                same values, the written variables get their new values
+                from the table without running fire_transition.
+  symbolic      The states are constructed as binary decision diagrams, ring
+                by ring in breadth-first order, instead of one by one. The
+                relation of each transition is learned by firing it, so tr_vars
+                should declare few variables per transition. State and
+                deadlock errors are detected; progress and properties are
+                not checked. Not with components, lts_input or only_typical.
+  best_first    States are investigated in the order of increasing
+                distance() instead of breadth-first. Requires heuristic.
+                Finds deep errors sooner, but the counterexample need not be
+                the shortest. Otherwise the same checks are made.
+  a_star        Like best_first, but the order is by the sum of the length of
+                the path by which the state was found and distance(). If a
+                shorter path to a state is found before the state has been
+                investigated, the state gets the shorter path. States are not
+                investigated again.
+  beam_width    States are investigated breadth-first level by level, but of
+                each level, only this many with the smallest distance() are
+                investigated. Requires heuristic. The rest of the states are
+                dropped, so errors may be missed, and progress is not checked.
+  bidirectional Searches for a shortest path to a goal state by breadth-first
+                search forward from the initial state and backward from the
+                goal states at the same time. Requires backward and
+                chk_state. Only check_state errors are looked for. Not with
+                symmetry, components, lts_input, or only_typical, and has
+                priority over stubborn, tr_cache, and the directed search and
+                file options other than prev_file.
+  telemetry     Name of a file (as a string literal, "-" for stderr) to which
+                a background thread appends a line of statistics of the
+                construction of the state space every telem_ms (default
+                1000) milliseconds: rates, queue length, breadth-first level,
+                hash table load, memory use, and an estimate of the remaining
+                time. Implies no_show_cnt.
+  packed_edges  The incoming edges for the progress checks are stored as
+                variable-length differences of the numbers of their source
+                states, usually taking one or two bytes per edge instead of
+                4 or 8. The sizes are counted during construction, except
+                that with best_first, a_star, beam_width, mem_budget, or
+                load_file the edges are generated one more time for them.
+                Not with minimize or lts_input, and the edges are not stored
+                in save_file.
+  edge_file     Name of temporary files (as a string literal, to which ".0",
+                ".1", and so on is appended) in which the incoming edges for
+                the progress checks are kept instead of main memory. The
+                states are divided into edge_buckets (default 64) ranges,
+                each with a file of the edges that end in it. The files are
+                read in passes, skipping those of the ranges where nothing
+                has changed. The progress checks become slower. Not with
+                minimize or lts_input, has priority over packed_edges, and
+                the edges are not stored in save_file.
+  estimate      Instead of checking the model, the first this many states
+                are constructed breadth-first, and the numbers of states,
+                edges, and breadth-first levels and the memory use with the
+                other settings are estimated from the sizes of the levels.
+                The estimates are rough, the true numbers may well be
+                bigger or smaller. Safety and other errors are not looked
+                for, and stubborn sets are not used. Has priority over
+                symbolic and bidirectional. Not with components, lts_input,
+                or only_typical.
+  stats_file    Name of a file (as a string literal, "-" for stdout) to which
+                a JSON object describing the shape of the constructed state
+                space is written: the numbers of states per breadth-first
+                level, the distributions of the numbers of outgoing and
+                incoming edges, the number of terminal states, the number
+                and sizes of strongly connected components, and the lengths
+                of the lists of the hash table. Makes the incoming edges be
+                constructed even if progress is not checked, without
+                checking it then. Not with
+                components, symbolic, estimate, only_typical, beam_width, or
+                bidirectional, and has priority over edge_file.
+  dfs_cache     The states are searched depth-first, keeping only a cache of
+                this many megabytes of states instead of all of them. When
+                the cache is full, the least recently used state is evicted,
+                or a random one if dfs_random is defined. Evicted states
+                that are found again are investigated again, which may take
+                much more time. The counterexample is the stack, so it need
+                not be the shortest. Safety and deadlock errors are looked
+                for. With stubborn, a state whose stubborn set leads to a
+                state on the stack is fully expanded. Not with
+                chk_may_progress, chk_must_progress, chk_props, components,
+                lts_input, only_typical, estimate, symbolic, or
+                bidirectional, and has priority over the directed search,
+                file, budget, telemetry, and profiling options.
+  wide_idx      States and edges are numbered with 64-bit instead of 32-bit
+                unsigned ints, so that there may be more than 4 billion of
+                them. Uses more memory per state and edge. Must be given as a
+                compile-time option, because it is needed before the model.
 */
 
 
 #include <iostream>
 #include <vector>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __x86_64__
+#include <x86intrin.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 
 /* A description of a detected error is given via this. */
 const char *err_msg = 0;
 
+/* Data types for numbers of states (nodes) and edges */
+#ifdef wide_idx
+typedef unsigned long long node_idx, edge_idx;
+#else
+typedef unsigned node_idx, edge_idx;
+#endif
+
+/* Records that the transition whose variables are being declared reads, or
+  also writes, the bits mask of word number word of the state. */
+void tr_decl( unsigned word, unsigned mask, bool write );
+
 /* Data type for state variables */
 /* Raw state data is in a vector of unsigned ints. State number i occupies the
   locations i * nr_words ... (i+1) * nr_words - 1. A state variable occupies
   some successive bits inside one location. */
 class state_var{
 
-  friend void use_state( unsigned );
-  friend void fire_init( unsigned );
-  friend unsigned int hash_try( bool );
+  friend void use_state( node_idx );
+  friend void fire_init( node_idx );
+  friend node_idx hash_try( bool );
   friend void store_initial_state();
+  friend void save_state_space();
+  friend void load_state_space();
+  friend void budget_configure();
+  friend size_t budget_per_state();
+  friend void pk_setup();
+  friend void pk_pack( node_idx, unsigned * );
+  friend void pk_unpack( node_idx );
+  friend void st_rebase( node_idx );
+  friend bool shrink_room();
+  friend bool shrink_states( node_idx );
+  friend bool st_equal( node_idx, node_idx );
+  friend double est_bytes( double, double );
+  friend void write_stats();
+  friend void dc_setup();
+  friend void verify_dfs();
+  friend void lts_open();
+  friend void lts_edge( node_idx, unsigned, node_idx );
+  friend void lts_read( bool );
+  friend void state_row( node_idx, std::vector< unsigned > &, bool );
+  template< bool > friend bool fire_cached( unsigned );
+  friend class channel;
+  template< unsigned, unsigned > friend class state_array;
 
   static std::vector<unsigned> st_data; // raw state data
   static bool started;      // true after declaring the state variables
   static unsigned nr_words; // number of words used by a state
   static unsigned tot_bits; // number of used bits in most recent word
-  static unsigned state_nr; // number of the current state
+  static node_idx state_nr; // number of the current state
+  static unsigned layout_fp;  // fingerprint of the layout of state variables
+  static std::vector<unsigned> used_bits; // number of used bits of each word
   unsigned word,            // number of word where the state variable is
     shift, mask;            // for extracting the state var. from inside word
 
@@ -196,9 +521,28 @@ public:
       ++nr_words; tot_bits = 0;
     }
     word = nr_words - 1; shift = tot_bits; tot_bits += nr_bits;
+    used_bits.resize( nr_words ); used_bits[ word ] = tot_bits;
     mask = ((1u << nr_bits) - 1) << shift;
+    layout_fp = layout_fp * 1234567 + ( word << 16 | shift << 8 | nr_bits );
   }
 
+private:
+
+  /* Reserves cnt whole words for a channel or an array and returns the
+    number of the first of them. The next state variable starts a new word. */
+  static unsigned reserve_words( unsigned cnt, unsigned fp ){
+    unsigned first = nr_words;
+    nr_words += cnt; tot_bits = sizeof( unsigned )*8;
+    used_bits.resize( first ); used_bits.resize( nr_words, tot_bits );
+    layout_fp = layout_fp * 1234567 + ( first << 16 ^ fp );
+    return first;
+  }
+
+public:
+
+  /* Returns the fingerprint of the layout of the state variables. */
+  inline static unsigned layout(){ return layout_fp + nr_words; }
+
   /* Returns the value of a state variable as an unsigned int. */
   inline operator unsigned() const {
     return (st_data[ state_nr * nr_words + word ] & mask) >> shift;
@@ -254,13 +598,16 @@ public:
     *this = unsigned( *this ) ^ val; return *this;
   }
 
+  /* Declares the state variable as read or written by a transition. */
+  void declare( bool write ) const { tr_decl( word, mask, write ); }
+
   /* True, iff the state is the initial state */
   inline static bool is_initial(){ return state_nr == 1; }
 
   /* True, iff all state variables are zero */
   inline static bool is_zero(){
-    unsigned end = (state_nr + 1) * nr_words;
-    for( unsigned ii = state_nr * nr_words; ii < end; ++ii ){
+    node_idx end = (state_nr + 1) * nr_words;
+    for( node_idx ii = state_nr * nr_words; ii < end; ++ii ){
       if( st_data[ii] ){ return false; }
     }
     return true;
@@ -271,7 +618,316 @@ std::vector<unsigned> state_var::st_data;
 bool state_var::started(false);
 unsigned state_var::nr_words(1);    // the first word is reserved ...
 unsigned state_var::tot_bits(0);    // ... but is initially totally unused
-unsigned state_var::state_nr(0);
+node_idx state_var::state_nr(0);
+unsigned state_var::layout_fp(0);
+std::vector<unsigned> state_var::used_bits;
+
+
+/* Word-level operations on cells packed into whole words */
+/* Each word contains per_word cells of bits bits. Cell i is in word
+  i / per_word at bit position i % per_word * bits. Unused bits are 0. */
+
+/* Returns the number of the lowest 1-bit of ww, which must not be 0. */
+inline unsigned lowest_bit( unsigned ww ){
+  #ifdef __GNUC__
+  return __builtin_ctz( ww );
+  #else
+  unsigned nb = 0;
+  for( ; !( ww & 0xffff ); ww >>= 16 ){ nb += 16; }
+  for( ; !( ww & 1 ); ww >>= 1 ){ ++nb; }
+  return nb;
+  #endif
+}
+
+/* Returns the mask that has the lowest bit of the first cnt cells. */
+inline unsigned cells_low( unsigned cnt, unsigned bits ){
+  unsigned low = 0;
+  for( unsigned ii = 0; ii < cnt; ++ii ){ low |= 1u << ii * bits; }
+  return low;
+}
+
+/* Returns a mask with the highest bit of each non-zero cell of ww, given the
+  mask low of the lowest bits of the cells in ww. */
+inline unsigned cells_nonzero( unsigned ww, unsigned low, unsigned bits ){
+  unsigned hi = low << ( bits - 1 ), rest = hi - low;
+  return ( ( ( ww & rest ) + rest ) | ww ) & hi;
+}
+
+/* Removes cell ii from the cells in words dd[0] ... dd[wl], by moving the
+  cells after it one step down. Returns the removed cell. The shifts are made
+  in 64 bits, because bits may be 32. */
+unsigned cells_remove(
+  unsigned *dd, unsigned ii, unsigned wl, unsigned bits, unsigned per_word
+){
+  unsigned
+    msk = ( 2u << ( bits - 1 ) ) - 1, wi = ii / per_word,
+    sh = ii % per_word * bits, cell = dd[ wi ] >> sh & msk;
+  unsigned long long ww = dd[ wi ];
+  ww = ( ww & ( ( 1ull << sh ) - 1 ) ) | ( ww >> ( sh + bits ) << sh );
+  for( ; wi < wl; ++wi ){
+    ww |= (unsigned long long)( dd[ wi+1 ] & msk )
+      << ( ( per_word - 1 ) * bits );
+    dd[ wi ] = ww; ww = (unsigned long long)dd[ wi+1 ] >> bits;
+  }
+  dd[ wi ] = ww; return cell;
+}
+
+
+/* Data type for packed arrays of state variables */
+template< unsigned cnt, unsigned bits = 8 >
+class state_array{
+
+  static const unsigned
+    per_word = sizeof( unsigned )*8 / bits,   // cells in a word
+    nr_w = ( cnt + per_word - 1 ) / per_word, // words in the array
+    last_cnt = cnt - ( nr_w - 1 ) * per_word, // cells in the last word
+    msk = ( 2u << ( bits - 1 ) ) - 1;         // mask of one cell
+  unsigned first;                             // number of the first word
+
+  /* Returns a pointer to the words of the array in the current state. */
+  inline unsigned *data() const {
+    return &state_var::st_data[
+      state_var::state_nr * state_var::nr_words + first
+    ];
+  }
+
+  /* Returns the mask of the lowest bits of the cells in word wi. */
+  inline static unsigned low( unsigned wi ){
+    return cells_low( wi + 1 < nr_w ? per_word : last_cnt, bits );
+  }
+
+  /* Returns the index of the first cell at or after ii whose highest bit is
+    in the mask that fn( word, low mask ) computes. */
+  template< class Fn > unsigned find( unsigned ii, Fn fn ) const {
+    const unsigned *dd = data();
+    for( unsigned wi = ii / per_word; wi < nr_w; ++wi ){
+      unsigned mm = fn( dd[ wi ], low( wi ) );
+      if( wi == ii / per_word ){ mm &= ~0u << ii % per_word * bits; }
+      if( mm ){ return wi * per_word + lowest_bit( mm ) / bits; }
+    }
+    return cnt;
+  }
+  struct nonzero_fn{
+    unsigned operator()( unsigned ww, unsigned lw ) const {
+      return cells_nonzero( ww, lw, bits );
+    }
+  };
+  struct zero_fn{
+    unsigned operator()( unsigned ww, unsigned lw ) const {
+      return ~cells_nonzero( ww, lw, bits ) & lw << ( bits - 1 );
+    }
+  };
+
+public:
+
+  /* A reference to a cell, usable like a state variable */
+  class cell{
+    unsigned *wp, shift;
+  public:
+    cell( unsigned *wp, unsigned shift ): wp( wp ), shift( shift ){}
+    inline operator unsigned() const { return *wp >> shift & msk; }
+    inline unsigned operator =( unsigned val ){
+      #ifndef no_sanity_chk
+      if( val & ~msk ){
+        err_msg = "Assigned an out of range value to a variable";
+      }
+      #endif
+      *wp = ( *wp & ~( msk << shift ) ) | ( val & msk ) << shift;
+      return val;
+    }
+    inline unsigned operator =( const cell &cl ){
+      unsigned val = cl; *this = val; return val;
+    }
+    inline unsigned operator ++(){ return *this = unsigned( *this ) + 1; }
+    inline unsigned operator --(){ return *this = unsigned( *this ) - 1; }
+    inline unsigned operator +=( unsigned val ){
+      return *this = unsigned( *this ) + val;
+    }
+    inline unsigned operator -=( unsigned val ){
+      return *this = unsigned( *this ) - val;
+    }
+    void declare( bool write ) const {
+      tr_decl(
+        wp - &state_var::st_data[
+          state_var::state_nr * state_var::nr_words
+        ], msk << shift, write
+      );
+    }
+  };
+
+  /* The constructor reserves whole words for the cells. */
+  state_array(): first( 0 ){
+    if( state_var::started ){
+      err_msg = "State variables must not be created after start"; return;
+    }
+    if( !cnt || !bits || bits > sizeof( unsigned )*8 ){
+      err_msg = "Wrong size of a state array"; return;
+    }
+    first = state_var::reserve_words( nr_w, cnt << 8 | bits );
+  }
+
+  inline cell operator []( unsigned ii ){
+    return cell( data() + ii / per_word, ii % per_word * bits );
+  }
+  inline unsigned operator []( unsigned ii ) const {
+    return data()[ ii / per_word ] >> ( ii % per_word * bits ) & msk;
+  }
+
+  unsigned find_nonzero( unsigned ii = 0 ) const {
+    return find( ii, nonzero_fn() );
+  }
+  unsigned find_zero( unsigned ii = 0 ) const {
+    return find( ii, zero_fn() );
+  }
+
+  bool is_zero() const {
+    const unsigned *dd = data();
+    for( unsigned wi = 0; wi < nr_w; ++wi ){ if( dd[ wi ] ){ return false; } }
+    return true;
+  }
+
+  void fill( unsigned val ){
+    #ifndef no_sanity_chk
+    if( val & ~msk ){
+      err_msg = "Assigned an out of range value to a variable";
+    }
+    #endif
+    unsigned *dd = data();
+    for( unsigned wi = 0; wi < nr_w; ++wi ){
+      dd[ wi ] = ( val & msk ) * low( wi );
+    }
+  }
+
+  inline unsigned remove( unsigned ii ){
+    return cells_remove( data(), ii, nr_w - 1, bits, per_word );
+  }
+  inline void shift_down(){ remove(0); }
+
+  void shift_up(){
+    unsigned *dd = data(), carry = 0;
+    for( unsigned wi = 0; wi < nr_w; ++wi ){
+      unsigned ww = dd[ wi ];
+      dd[ wi ] = ( (unsigned long long)ww << bits | carry ) & msk * low( wi );
+      carry = ww >> ( per_word - 1 ) * bits & msk;
+    }
+  }
+
+  bool operator ==( const state_array &other ) const {
+    const unsigned *d1 = data(), *d2 = other.data();
+    for( unsigned wi = 0; wi < nr_w; ++wi ){
+      if( d1[ wi ] != d2[ wi ] ){ return false; }
+    }
+    return true;
+  }
+  inline bool operator !=( const state_array &other ) const {
+    return !( *this == other );
+  }
+
+  void declare( bool write ) const {
+    for( unsigned wi = 0; wi < nr_w; ++wi ){
+      tr_decl( first + wi, ~0u, write );
+    }
+  }
+
+};
+
+
+/* Data type for bounded FIFO channels */
+/* The messages occupy whole words of their own, each word containing as many
+  messages as fits. Message i is in word i / per_word at bit position
+  i % per_word * bits. Unused message bits are always 0. */
+class channel{
+
+  state_var len;          // number of messages in the channel
+  unsigned cap, bits,     // capacity, and number of bits of a message
+    per_word, msk,        // messages in a word, and mask of one message
+    first;                // number of the first word of the messages
+
+  /* Returns the number of bits that the length field needs. */
+  static unsigned len_bits( unsigned cap ){
+    unsigned nb = 1;
+    while( nb < sizeof( unsigned )*8 && cap >> nb ){ ++nb; }
+    return nb;
+  }
+
+  /* Returns a pointer to the words of the messages in the current state. */
+  inline unsigned *data() const {
+    return &state_var::st_data[
+      state_var::state_nr * state_var::nr_words + first
+    ];
+  }
+
+public:
+
+  /* The constructor reserves the length field and then whole words for the
+    messages. The next state variable will start a new word. */
+  channel( unsigned capacity, unsigned msg_bits = 8 ):
+    len( len_bits( capacity ) ), cap( capacity ), bits( msg_bits ),
+    per_word( 0 ), msk( 0 ), first( 0 )
+  {
+    if( state_var::started ){
+      err_msg = "Channels must not be created after start"; return;
+    }
+    if( !bits || bits > sizeof( unsigned )*8 || !cap ){
+      err_msg = "Wrong capacity or message size of a channel"; return;
+    }
+    per_word = sizeof( unsigned )*8 / bits;
+    msk = ( 2u << ( bits - 1 ) ) - 1;
+    first = state_var::reserve_words(
+      ( cap + per_word - 1 ) / per_word, cap << 8 | bits
+    );
+  }
+
+  inline unsigned length() const { return len; }
+  inline bool empty() const { return !len; }
+  inline bool full() const { return len >= cap; }
+
+  /* Returns the message at position ii, or 0 if there is no such message. */
+  inline unsigned operator []( unsigned ii ) const {
+    if( ii >= len ){ return 0; }
+    return data()[ ii / per_word ] >> ( ii % per_word * bits ) & msk;
+  }
+  inline unsigned peek() const { return (*this)[0]; }
+
+  /* Adds msg to the end of the channel, unless the channel is full. */
+  inline bool send( unsigned msg ){
+    unsigned ll = len;
+    if( ll >= cap ){ return false; }
+    #ifndef no_sanity_chk
+    if( msg & ~msk ){ err_msg = "Sent an out of range message to a channel"; }
+    #endif
+    data()[ ll / per_word ] |= ( msg & msk ) << ( ll % per_word * bits );
+    len = ll + 1; return true;
+  }
+
+  /* Removes the message at position ii and returns it. The messages after it
+    are shifted one position towards the front, a word at a time. */
+  unsigned lose( unsigned ii ){
+    unsigned ll = len;
+    if( ii >= ll ){
+      err_msg = "Removed a nonexistent message from a channel"; return 0;
+    }
+    len = ll - 1;
+    return cells_remove( data(), ii, ( ll - 1 ) / per_word, bits, per_word );
+  }
+  inline unsigned receive(){ return lose(0); }
+
+  /* Removes all messages. */
+  inline void clear(){
+    unsigned *dd = data(), end = ( cap + per_word - 1 ) / per_word;
+    for( unsigned wi = 0; wi < end; ++wi ){ dd[ wi ] = 0; }
+    len = 0;
+  }
+
+  void declare( bool write ) const {
+    len.declare( write );
+    unsigned end = ( cap + per_word - 1 ) / per_word;
+    for( unsigned wi = 0; wi < end; ++wi ){
+      tr_decl( first + wi, ~0u, write );
+    }
+  }
+
+};
 
 
 /* Forward declarations of stubborn set obligation functions */
@@ -284,15 +940,224 @@ inline void stb( unsigned, unsigned, unsigned );
 inline void stb( unsigned, unsigned, unsigned, unsigned );
 inline void stb_all();
 
+/* Functions via which the model declares the variables of a transition */
+template< class T > inline void rd( const T &var ){ var.declare( false ); }
+template< class T > inline void wr( const T &var ){ var.declare( true ); }
+
+/* Forward declarations of property registration functions */
+void prop_state( const char *, const char *(*)() );
+void prop_deadlock( const char *, const char *(*)() );
+void prop_may( const char *, bool (*)() );
+void prop_must( const char *, bool (*)() );
+
 
 /* The model under analysis comes from the user's file. */
 namespace model{
   #include "asset.model"
 }
 
+/* Adjust estimate. */
+#ifdef components
+#undef estimate
+#endif
+#ifdef lts_input
+#undef estimate
+#endif
+#ifdef only_typical
+#undef estimate
+#endif
+
+/* Adjust stats_file. */
+#ifdef components
+#undef stats_file
+#endif
+#ifdef only_typical
+#undef stats_file
+#endif
+#ifdef estimate
+#undef stats_file
+#endif
+#ifdef symbolic
+#undef stats_file
+#endif
+#ifdef stats_file
+#undef edge_file
+#endif
+
+/* Adjust bidirectional. */
+#ifndef backward
+#undef bidirectional
+#endif
+#ifndef chk_state
+#undef bidirectional
+#endif
+#ifdef components
+#undef bidirectional
+#endif
+#ifdef lts_input
+#undef bidirectional
+#endif
+#ifdef only_typical
+#undef bidirectional
+#endif
+#ifdef symmetry
+#undef bidirectional
+#endif
+#ifdef symbolic
+#undef bidirectional
+#endif
+#ifdef bidirectional
+#undef tr_cache
+#undef stubborn
+#undef save_file
+#undef load_file
+#undef lts_file
+#undef aut_file
+#undef best_first
+#undef a_star
+#undef beam_width
+#endif
+
+/* Adjust tr_cache and symbolic, and decide whether the variables of the
+  transitions are needed. */
+#ifdef components
+#undef symbolic
+#endif
+#ifdef lts_input
+#undef symbolic
+#endif
+#ifdef only_typical
+#undef symbolic
+#endif
+#ifndef tr_vars
+#undef tr_cache
+#endif
+#ifdef lts_input
+#undef tr_cache
+#endif
+#ifdef only_typical
+#undef tr_cache
+#endif
+#ifdef components
+#undef tr_cache
+#endif
+#ifdef symbolic
+#undef tr_cache
+#define tr_decls
+#endif
+#ifdef tr_cache
+#define tr_decls
+#endif
+
+/* Adjust warm_up. It only concerns the sanity checks of tr_cache. */
+#ifdef no_sanity_chk
+#undef warm_up
+#endif
+#ifndef tr_cache
+#undef warm_up
+#endif
+
+/* Adjust dfs_cache. */
+#ifdef components
+#undef dfs_cache
+#endif
+#ifdef lts_input
+#undef dfs_cache
+#endif
+#ifdef only_typical
+#undef dfs_cache
+#endif
+#ifdef estimate
+#undef dfs_cache
+#endif
+#ifdef symbolic
+#undef dfs_cache
+#endif
+#ifdef bidirectional
+#undef dfs_cache
+#endif
+#ifdef chk_may_progress
+#undef dfs_cache
+#endif
+#ifdef chk_must_progress
+#undef dfs_cache
+#endif
+#ifdef chk_props
+#undef dfs_cache
+#endif
+#ifdef dfs_cache
+#undef best_first
+#undef a_star
+#undef beam_width
+#undef save_file
+#undef load_file
+#undef lts_file
+#undef aut_file
+#undef prev_file
+#undef mem_budget
+#undef telemetry
+#undef warm_up
+#undef profile
+#undef stats_file
+#endif
+
+/* Adjust the directed search options. */
+#ifndef heuristic
+#undef best_first
+#undef a_star
+#undef beam_width
+#endif
+#ifdef beam_width
+#undef best_first
+#undef a_star
+#endif
+#ifdef a_star
+#undef best_first
+#endif
+#ifdef best_first
+#define directed
+#endif
+#ifdef a_star
+#define directed
+#endif
+#ifdef beam_width
+#define directed
+#endif
+#ifdef save_file
+#undef directed
+#endif
+#ifdef load_file
+#undef directed
+#endif
+#ifdef lts_input
+#undef directed
+#endif
+#ifdef only_typical
+#undef directed
+#endif
+#ifdef components
+#undef directed
+#endif
+#ifdef symbolic
+#undef directed
+#endif
+#ifndef directed
+#undef best_first
+#undef a_star
+#undef beam_width
+#endif
+
+/* Telemetry replaces the running number of states. */
+#ifdef telemetry
+#ifndef no_show_cnt
+#define no_show_cnt
+#endif
+#endif
+
 /* Adjust no_progr_chk. */
 #ifndef chk_must_progress
 #ifndef chk_may_progress
+#ifndef chk_props
 #ifndef stubborn
 #define no_progr_chk
 #endif
@@ -301,27 +1166,148 @@ namespace model{
 #endif
 #endif
 #endif
+#endif
 #ifdef only_typical
 #undef no_progr_chk
 #endif
+#ifdef stats_file
+#ifdef no_progr_chk
+#define stats_only    // the incoming edges are only made for stats_file
+#endif
+#undef no_progr_chk
+#endif
+#ifdef dfs_cache
+#define no_progr_chk
+#endif
+#ifdef beam_width
+#define no_progr_chk
+#endif
+#ifdef bidirectional
+#define no_progr_chk
+#endif
+#ifdef no_progr_chk
+#undef stats_file
+#undef stats_only
+#endif
+
+/* Adjust minimize, decide whether edges must remember their transition, and
+  decide whether bisimulation is needed. */
+#ifdef no_progr_chk
+#undef minimize
+#endif
+#ifdef minimize
+#define bisim
+#ifdef visible_tr
+#define tr_labels
+#endif
+#endif
+#ifdef components
+#define bisim
+#endif
+
+/* Adjust edge_file and packed_edges. */
+#ifdef no_progr_chk
+#undef edge_file
+#endif
+#ifdef minimize
+#undef edge_file
+#endif
+#ifdef lts_input
+#undef edge_file
+#endif
+#ifdef edge_file
+#undef packed_edges
+#endif
+#ifdef no_progr_chk
+#undef packed_edges
+#endif
+#ifdef minimize
+#undef packed_edges
+#endif
+#ifdef lts_input
+#undef packed_edges
+#endif
+
+/* Packed edges are sized during construction, if it is in source order and
+  may spend the memory of ie_last. */
+#ifdef packed_edges
+#define packed_sized
+#endif
+#ifdef directed
+#undef packed_sized
+#endif
+#ifdef mem_budget
+#undef packed_sized
+#endif
+#ifdef load_file
+#undef packed_sized
+#endif
+
+/* Decide whether construction may stop between states. */
+#ifdef save_file
+#define stop_between
+#endif
+#ifdef mem_budget
+#define stop_between
+#endif
+
+/* Decide whether the investigated states may be shrunk to fit in the memory
+  budget. This relies on the states being investigated in the order of their
+  numbers, and on not needing them after construction. */
+#ifdef mem_budget
+#define budget_shrink
+#endif
+#ifdef save_file
+#undef budget_shrink
+#endif
+#ifdef estimate
+#undef budget_shrink
+#endif
+#ifdef directed
+#undef budget_shrink
+#endif
+#ifdef bidirectional
+#undef budget_shrink
+#endif
+#ifdef components
+#undef budget_shrink
+#endif
+#ifdef symbolic
+#undef budget_shrink
+#endif
+#ifdef lts_input
+#undef budget_shrink
+#endif
+#ifdef only_typical
+#undef budget_shrink
+#endif
 
 /* Numerical settings that the user may affect. */
+/* With mem_budget, hash_bits and stop_count are set by budget_configure. */
 const unsigned
   #ifdef show_cnt       // how often to show the number of states
-  show_count = show_cnt,
-  #else
-  show_count = 1000,
-  #endif
-  #ifdef stop_cnt       // abort after this many states
-  stop_count = stop_cnt,
+  show_count = show_cnt;
   #else
-  stop_count = 30000000,
+  show_count = 1000;
   #endif
+#ifndef mem_budget
+const
+#endif
+unsigned
   #ifdef hash_count     // hash table size is 2^hash_bits
   hash_bits = hash_count;
   #else
   hash_bits = 23;
   #endif
+#ifndef mem_budget
+const
+#endif
+node_idx
+  #ifdef stop_cnt       // abort after this many states
+  stop_count = stop_cnt;
+  #else
+  stop_count = 30000000;
+  #endif
 
 /* Miscellaneous that must be early on in this file. */
 unsigned nr_trans = 0;  // number of structural transitions in the model
@@ -366,37 +1352,351 @@ inline void stb_all(){
 }
 
 
-/* Nodes of the state space */
-struct node_type{
-  unsigned h_next;      // next in the hash list
-  unsigned prev;        // the finding predecessor node of the current node
-  #ifndef no_progr_chk
-  unsigned e_cnt;       // counts remaining non-progress edges, etc.
-  unsigned p_next;      // next in the progress search list
-  unsigned ie_end;      // used for counting-sorting incoming edges
-  #endif
+/* Registered properties */
+/* The node of a property is 0 until the property is found violated, and then
+  it is the node where the violation was detected. */
+enum{ prop_st, prop_dl, prop_may_pr, prop_must_pr };
+struct prop_type{
+  const char *name;
+  unsigned kind;              // one of prop_st, ..., prop_must_pr
+  const char *(*check)();     // for prop_st and prop_dl
+  bool (*is_progress)();      // for prop_may_pr and prop_must_pr
+  node_idx node;              // the node where a violation was detected
+  const char *msg;            // the message given by check
 };
-std::vector< node_type > nodes; // (0 = end mark, so location 0 is unused)
-unsigned nr_edges = 0;  // number of edges in the state space
+std::vector< prop_type > props;
+void prop_add( const char *name, unsigned kind, const char *(*check)(),
+  bool (*is_progress)()
+){
+  prop_type pr = { name, kind, check, is_progress, 0, 0 };
+  props.push_back( pr );
+}
+void prop_state( const char *name, const char *(*check)() ){
+  prop_add( name, prop_st, check, 0 );
+}
+void prop_deadlock( const char *name, const char *(*check)() ){
+  prop_add( name, prop_dl, check, 0 );
+}
+void prop_may( const char *name, bool (*is_progress)() ){
+  prop_add( name, prop_may_pr, 0, is_progress );
+}
+void prop_must( const char *name, bool (*is_progress)() ){
+  prop_add( name, prop_must_pr, 0, is_progress );
+}
 
-/* Start using the state variables of state number ni. */
-inline void use_state( unsigned ni ){ state_var::state_nr = ni; }
 
-/* Copy state ni to first unused locations, so that it can be modified. */
-inline void fire_init( unsigned ni ){
-  unsigned
-    jj = nodes.size() * state_var::nr_words,
-    end = (ni + 1) * state_var::nr_words;
-  for( unsigned ii = ni * state_var::nr_words; ii < end; ++ii, ++jj ){
-    state_var::st_data[ jj ] = state_var::st_data[ ii ];
-  }
-  use_state( nodes.size() );
+/* A column of node numbers in a file */
+/* The most recently added values are kept in a buffer in main memory until
+  the buffer fills up. Older values are in the file, which is read and written
+  a page at a time via a one-page cache. The file is removed as soon as it has
+  been created. A read or write that does not transfer all bytes is an error.
+*/
+#ifdef prev_file
+class file_column{
+
+  int fd;                     // the file, or -1 if not yet created
+  node_idx nr_file;           // number of values in the file
+  std::vector< node_idx > buf;  // values number nr_file, nr_file + 1, ...
+  static const unsigned buf_max = 1u << 16;
+  static const unsigned pg_len = 1u << 10;  // values per page
+  mutable std::vector< node_idx > pg;  // the cached page
+  mutable node_idx pg_beg;    // number of the first value in pg
+  mutable bool pg_dirty;      // pg has been changed since it was read
+
+  /* Reads or writes cnt values starting at value number ii of the file. */
+  bool file_read( node_idx ii, node_idx *vv, node_idx cnt ) const {
+    ssize_t nn = cnt * sizeof( node_idx );
+    if( pread( fd, vv, nn, off_t( ii ) * sizeof( node_idx ) ) != nn ){
+      err_msg = "Cannot read prev_file"; return false;
+    }
+    return true;
+  }
+  bool file_write( node_idx ii, const node_idx *vv, node_idx cnt ) const {
+    ssize_t nn = cnt * sizeof( node_idx );
+    if( pwrite( fd, vv, nn, off_t( ii ) * sizeof( node_idx ) ) != nn ){
+      err_msg = "Cannot write prev_file"; return false;
+    }
+    return true;
+  }
+
+  /* Writes the cached page back if it has been changed, and empties it. */
+  void pg_drop() const {
+    if( pg_dirty ){ file_write( pg_beg, &pg[0], pg.size() ); }
+    pg.clear(); pg_dirty = false;
+  }
+
+  /* Makes pg the page that contains value number ii of the file. */
+  void pg_load( node_idx ii ) const {
+    node_idx beg = ii - ii % pg_len;
+    if( !pg.empty() && beg == pg_beg ){ return; }
+    pg_drop();
+    node_idx cnt = nr_file - beg < pg_len ? nr_file - beg : pg_len;
+    pg.resize( cnt ); pg_beg = beg;
+    if( !file_read( beg, &pg[0], cnt ) ){
+      for( node_idx jj = 0; jj < cnt; ++jj ){ pg[ jj ] = 0; }
+    }
+  }
+
+  node_idx get( node_idx ii ) const {
+    if( ii >= nr_file ){ return buf[ ii - nr_file ]; }
+    pg_load( ii ); return pg[ ii - pg_beg ];
+  }
+
+  void set( node_idx ii, node_idx val ){
+    if( ii >= nr_file ){ buf[ ii - nr_file ] = val; return; }
+    pg_load( ii ); pg[ ii - pg_beg ] = val; pg_dirty = true;
+  }
+
+  /* Moves the buffer to the end of the file. */
+  void flush(){
+    if( fd < 0 ){
+      fd = open( prev_file, O_RDWR | O_CREAT | O_TRUNC, 0600 );
+      if( fd < 0 ){ err_msg = "Cannot create prev_file"; return; }
+      unlink( prev_file );
+    }
+    pg_drop();
+    if( !file_write( nr_file, &buf[0], buf.size() ) ){ return; }
+    nr_file += buf.size(); buf.clear();
+  }
+
+public:
+
+  /* A reference to a value of the column */
+  class ref{
+    file_column &fc; node_idx ii;
+  public:
+    ref( file_column &fc, node_idx ii ): fc( fc ), ii( ii ){}
+    inline operator node_idx() const { return fc.get( ii ); }
+    inline node_idx operator =( node_idx val ){ fc.set( ii, val ); return val; }
+  };
+
+  file_column(): fd( -1 ), nr_file( 0 ), pg_beg( 0 ), pg_dirty( false ){}
+  ~file_column(){ if( fd >= 0 ){ close( fd ); } }
+
+  inline node_idx size() const { return nr_file + buf.size(); }
+  void resize( node_idx nn ){
+    if( nn < nr_file ){ pg_drop(); nr_file = nn; buf.clear(); return; }
+    buf.resize( nn - nr_file );
+    if( buf.size() >= buf_max ){ flush(); }
+  }
+
+  inline ref operator []( node_idx ii ){ return ref( *this, ii ); }
+  inline node_idx operator []( node_idx ii ) const { return get( ii ); }
+
+};
+#endif
+
+
+/* Nodes of the state space */
+/* The information on the nodes is kept column by column, so that each phase
+  of the analysis only pays for the columns that it uses. h_next, prev, and
+  e_cnt are needed from the start. ie_end is allocated by
+  construct_input_edges and p_next by verify_progress. They are freed when the
+  progress checks are ready. (Node 0 is an end mark, so location 0 is unused.)
+*/
+struct node_cols{
+  std::vector< node_idx > h_next; // next in the hash list
+  #ifdef prev_file
+  file_column prev;
+  #else
+  std::vector< node_idx > prev;   // the finding predecessor node of the node
+  #endif
+  #ifndef no_progr_chk
+  std::vector< edge_idx > e_cnt;  // counts remaining non-progress edges, etc.
+  std::vector< node_idx > p_next; // next in the progress search list
+  std::vector< edge_idx > ie_end; // used for counting-sorting incoming edges
+  #endif
+  #ifdef packed_edges
+  std::vector< node_idx > ie_last;  // the previous source of packed edges
+  #endif
+
+  inline node_idx size() const { return h_next.size(); }
+
+  /* Changes the number of nodes in the columns of the construction phase. */
+  void resize( node_idx nn ){
+    h_next.resize( nn ); prev.resize( nn );
+    #ifndef no_progr_chk
+    e_cnt.resize( nn );
+    #endif
+    #ifdef packed_sized
+    ie_last.resize( nn );
+    #endif
+  }
+
+  /* Reserves room for nn nodes in the columns of the construction phase. */
+  void reserve( node_idx nn ){
+    h_next.reserve( nn );
+    #ifndef prev_file
+    prev.reserve( nn );
+    #endif
+    #ifndef no_progr_chk
+    e_cnt.reserve( nn );
+    #endif
+    #ifdef packed_sized
+    ie_last.reserve( nn );
+    #endif
+  }
+
+} nodes;
+edge_idx nr_edges = 0;  // number of edges in the state space
+
+/* Releases the memory of a column. */
+template< class T > inline void free_column( std::vector< T > &col ){
+  std::vector< T >().swap( col );
+}
+
+/* The slots of st_data */
+/* Normally the state of node ni is in slot ni. When the investigated states
+  have been shrunk to fit in the memory budget, the state of node ni is in
+  slot ni - st_off for ni >= st_base, nodes 0 and 1 keep slots 0 and 1, and
+  the states of the nodes from 2 to st_base - 1 are not in st_data. */
+#ifdef budget_shrink
+node_idx st_base = 2, st_off = 0;
+inline node_idx st_slot( node_idx ni ){
+  return ni >= st_base ? ni - st_off : ni;
+}
+#else
+inline node_idx st_slot( node_idx ni ){ return ni; }
+#endif
+
+/* Start using the state variables of state number ni. */
+inline void use_state( node_idx ni ){ state_var::state_nr = st_slot( ni ); }
+
+/* Copy state ni to first unused locations, so that it can be modified. */
+inline void fire_init( node_idx ni ){
+  node_idx
+    jj = st_slot( nodes.size() ) * state_var::nr_words,
+    ii = st_slot( ni ) * state_var::nr_words,
+    end = ii + state_var::nr_words;
+  for( ; ii < end; ++ii, ++jj ){
+    state_var::st_data[ jj ] = state_var::st_data[ ii ];
+  }
+  use_state( nodes.size() );
+}
+
+/* Copies state ni to words, or words to state ni if put. */
+void state_row( node_idx ni, std::vector< unsigned > &words, bool put ){
+  unsigned nw = state_var::nr_words;
+  if( put ){
+    for( unsigned ii = 0; ii < nw; ++ii ){
+      state_var::st_data[ ni * nw + ii ] = words[ ii ];
+    }
+  }else{
+    words.assign(
+      state_var::st_data.begin() + ni * nw,
+      state_var::st_data.begin() + ( ni + 1 ) * nw
+    );
+  }
 }
 
 
 /* The hash table */
-unsigned const hash_size = 1u << hash_bits;
-unsigned hash_tbl[ hash_size ] = {};
+#ifdef mem_budget
+node_idx hash_size = 0;
+std::vector< node_idx > hash_tbl;
+void hash_alloc( unsigned bits ){
+  hash_bits = bits; hash_size = node_idx( 1 ) << hash_bits;
+  hash_tbl.assign( hash_size, 0 );
+}
+#else
+node_idx const hash_size = node_idx( 1 ) << hash_bits;
+node_idx hash_tbl[ hash_size ] = {};
+#endif
+
+/* Packed states and signatures of the shrunk states */
+/* A packed state consists of the used bits of the words of the state, one
+  word after another, in pk_words words. The nodes from hc_base to st_base - 1
+  have a packed state in pk_data, and the nodes from 2 to hc_base - 1 only a
+  signature of the packed state in hc_sig. */
+#ifdef budget_shrink
+unsigned pk_words = 0;
+std::vector< unsigned > pk_data;
+node_idx hc_base = 2;
+std::vector< unsigned > hc_sig;
+
+/* Computes pk_words from the layout of the state variables. */
+void pk_setup(){
+  unsigned nb = 0;
+  state_var::used_bits.resize( state_var::nr_words );
+  for( unsigned ww = 0; ww < state_var::nr_words; ++ww ){
+    nb += state_var::used_bits[ ww ];
+  }
+  pk_words = ( nb + 31 ) / 32;
+}
+
+/* Packs the state in slot sl of st_data to pk. */
+void pk_pack( node_idx sl, unsigned *pk ){
+  const unsigned *st = &state_var::st_data[ sl * state_var::nr_words ];
+  unsigned long long acc = 0; unsigned nb = 0;
+  for( unsigned ww = 0; ww < state_var::nr_words; ++ww ){
+    unsigned bb = state_var::used_bits[ ww ];
+    if( !bb ){ continue; }
+    acc |= ( st[ ww ] & ( ~0ull >> ( 64 - bb ) ) ) << nb; nb += bb;
+    if( nb >= 32 ){ *pk++ = unsigned( acc ); acc >>= 32; nb -= 32; }
+  }
+  if( nb ){ *pk = unsigned( acc ); }
+}
+
+/* Unpacks the state of node ni to the slot after the free slot, and starts
+  using it. */
+void pk_unpack( node_idx ni ){
+  node_idx sl = st_slot( nodes.size() ) + 1;
+  unsigned nw = state_var::nr_words;
+  if( state_var::st_data.size() < ( sl + 1 ) * nw ){
+    state_var::st_data.resize( ( sl + 1 ) * nw );
+  }
+  const unsigned *pk = &pk_data[ ( ni - hc_base ) * pk_words ];
+  unsigned *st = &state_var::st_data[ sl * nw ];
+  unsigned long long acc = 0; unsigned nb = 0;
+  for( unsigned ww = 0; ww < nw; ++ww ){
+    unsigned bb = state_var::used_bits[ ww ];
+    if( nb < bb ){ acc |= (unsigned long long)( *pk++ ) << nb; nb += 32; }
+    st[ ww ] = bb ? unsigned( acc & ( ~0ull >> ( 64 - bb ) ) ) : 0;
+    acc >>= bb; nb -= bb;
+  }
+  state_var::state_nr = sl;
+}
+
+/* Returns the signature of a packed state. */
+inline unsigned hc_sign( const unsigned *pk ){
+  unsigned hh = 0x811c9dc5u;
+  for( unsigned ii = 0; ii < pk_words; ++ii ){
+    hh = ( hh ^ pk[ ii ] ) * 0x9e3779b1u; hh ^= hh >> 15;
+  }
+  return hh;
+}
+
+/* Tells whether node ni has the state in slot sl. The state in sl is packed
+  and signed at most once per search of the hash table. */
+std::vector< unsigned > pk_cand;  // the packed state in sl
+bool pk_cand_ok = false, hc_cand_ok = false;
+unsigned hc_cand = 0;             // the signature of the state in sl
+bool st_equal( node_idx ni, node_idx sl ){
+  unsigned nw = state_var::nr_words;
+  if( ni >= st_base || ni < 2 ){
+    const unsigned
+      *aa = &state_var::st_data[ st_slot( ni ) * nw ],
+      *bb = &state_var::st_data[ sl * nw ];
+    for( unsigned ii = 0; ii < nw; ++ii ){
+      if( aa[ ii ] != bb[ ii ] ){ return false; }
+    }
+    return true;
+  }
+  if( !pk_cand_ok ){
+    pk_cand.resize( pk_words ); pk_pack( sl, &pk_cand[0] ); pk_cand_ok = true;
+  }
+  if( ni >= hc_base ){
+    const unsigned *aa = &pk_data[ ( ni - hc_base ) * pk_words ];
+    for( unsigned ii = 0; ii < pk_words; ++ii ){
+      if( aa[ ii ] != pk_cand[ ii ] ){ return false; }
+    }
+    return true;
+  }
+  if( !hc_cand_ok ){ hc_cand = hc_sign( &pk_cand[0] ); hc_cand_ok = true; }
+  return hc_sig[ ni - 2 ] == hc_cand;
+}
+#endif
+
 
 /* Finding a state from or inserting it to the hash table */
 /* This function assumes that the state is in the next locations of st_data.
@@ -406,14 +1706,14 @@ unsigned hash_tbl[ hash_size ] = {};
   returns its index. If no_ins == false, hash_was_new tells if the state was
   new. */
 bool hash_was_new = false;
-unsigned hash_try( bool no_ins ){
+node_idx hash_try( bool no_ins ){
 
   /* Compute the hash value. */
-  unsigned
+  node_idx
     idx = 0,
-    beg = nodes.size() * state_var::nr_words,
+    beg = st_slot( nodes.size() ) * state_var::nr_words,
     end = beg + state_var::nr_words;
-  for( unsigned ii = beg; ii < end; ++ii ){
+  for( node_idx ii = beg; ii < end; ++ii ){
     idx ^= state_var::st_data[ ii ];
     idx ^= idx >> hash_bits; idx *= 1234567; idx += 5555555;
     idx ^= idx >> hash_bits; idx *= 1234567; idx += 5555555;
@@ -421,11 +1721,19 @@ unsigned hash_try( bool no_ins ){
   idx &= hash_size-1;
 
   /* Find the state from the hash list, if it is there. */
-  unsigned ni = hash_tbl[ idx ], ii = beg, jj = ni * state_var::nr_words;
+  #ifdef budget_shrink
+  node_idx ni = hash_tbl[ idx ];
+  pk_cand_ok = hc_cand_ok = false;
+  while( ni && !st_equal( ni, st_slot( nodes.size() ) ) ){
+    ni = nodes.h_next[ ni ];
+  }
+  #else
+  node_idx ni = hash_tbl[ idx ], ii = beg, jj = ni * state_var::nr_words;
   while( ni && ii < end ){
     if( state_var::st_data[ ii ] == state_var::st_data[ jj ] ){ ++ii; ++jj; }
-    else{ ni = nodes[ ni ].h_next; ii = beg; jj = ni * state_var::nr_words; }
+    else{ ni = nodes.h_next[ ni ]; ii = beg; jj = ni * state_var::nr_words; }
   }
+  #endif
   if( ni ){ hash_was_new = false; return ni; }
   else if( no_ins ){ return 0; }
 
@@ -435,17 +1743,187 @@ unsigned hash_try( bool no_ins ){
     err_msg = "Maximum number of states exceeded"; return ni;
   }
   nodes.resize( ni+1 );
-  state_var::st_data.resize( (ni + 2) * state_var::nr_words );
+  state_var::st_data.resize( ( st_slot( ni ) + 2 ) * state_var::nr_words );
   #ifndef no_progr_chk
-  nodes[ ni ].e_cnt = 0;
+  nodes.e_cnt[ ni ] = 0;
   #endif
-  nodes[ ni ].h_next = hash_tbl[ idx ]; hash_tbl[ idx ] = ni;
+  nodes.h_next[ ni ] = hash_tbl[ idx ]; hash_tbl[ idx ] = ni;
   hash_was_new = true; return ni;
 
 }
 
-inline unsigned hash_find(){ return hash_try( true ); }
-inline unsigned hash_insert(){ return hash_try( false ); }
+inline node_idx hash_find(){ return hash_try( true ); }
+inline node_idx hash_insert(){ return hash_try( false ); }
+
+
+/* Returns the resident set size of the process in bytes, or 0 if unknown. */
+size_t rss_bytes(){
+  char buf[64] = {};
+  int fd = open( "/proc/self/statm", O_RDONLY );
+  if( fd < 0 ){ return 0; }
+  ssize_t nn = read( fd, buf, sizeof( buf ) - 1 ); close( fd );
+  if( nn <= 0 ){ return 0; }
+  const char *pp = buf;
+  while( *pp && *pp != ' ' ){ ++pp; }
+  return size_t( strtoull( pp, 0, 10 ) ) * size_t( sysconf( _SC_PAGESIZE ) );
+}
+
+
+/* The memory budget */
+/* Half of the budget is planned for the construction of the states, and the
+  rest for the progress checks and other needs. The memory use of the process
+  is checked after every budget_step new states. */
+#ifdef mem_budget
+const size_t budget_bytes = size_t( mem_budget ) << 20;
+const node_idx budget_step = 4096;
+node_idx budget_next = 0;       // number of states at the next check
+bool budget_no_progr = false;   // progress checks were dropped
+
+/* Returns the number of bytes that the progress checks would still need. */
+size_t budget_progr_bytes(){
+  return
+    #ifdef edge_file
+    2 * nodes.size();
+    #else
+    sizeof( node_idx ) * nr_edges +
+    ( sizeof( edge_idx ) + sizeof( node_idx ) ) * nodes.size();
+    #endif
+}
+
+/* Returns the number of bytes that the construction needs per state. */
+size_t budget_per_state(){
+  size_t per_state =
+    sizeof( unsigned ) * state_var::nr_words + 3 * sizeof( node_idx );
+  #ifndef no_progr_chk
+  per_state += sizeof( edge_idx );
+  #endif
+  return per_state;
+}
+
+/* Chooses hash_bits and stop_count, and reserves the memory of the
+  construction phase, so that the growth of vectors does not overshoot. */
+void budget_configure(){
+  node_idx max_states = budget_bytes / 2 / budget_per_state();
+  if( max_states < 2 ){ max_states = 2; }
+  #ifdef stop_cnt
+  if( stop_count < max_states ){ max_states = stop_count; }
+  #endif
+  stop_count = max_states;
+  #ifdef hash_count
+  hash_alloc( hash_count );
+  #else
+  unsigned bits = 10;
+  while(
+    bits < 8 * sizeof( node_idx ) - 2 && node_idx( 2 ) << bits <= max_states
+  ){ ++bits; }
+  hash_alloc( bits );
+  #endif
+  nodes.reserve( max_states + 1 );
+  state_var::st_data.reserve( ( max_states + 2 ) * state_var::nr_words );
+}
+
+/* Checks the memory use after every budget_step new states. Drops the
+  progress checks if they would not fit in the budget. Returns false if
+  construction must stop. */
+bool budget_check(){
+  if( nodes.size() < budget_next ){ return true; }
+  budget_next = nodes.size() + budget_step;
+  size_t rss = rss_bytes();
+  #ifndef no_progr_chk
+  if( !budget_no_progr && rss + budget_progr_bytes() > budget_bytes ){
+    budget_no_progr = true;
+  }
+  #endif
+  return rss < budget_bytes / 20 * 19;
+}
+#endif
+
+
+/* Shrinking the investigated states */
+/* When construction reaches stop_count or the budget runs out, stop_count
+  is first raised as far as the memory that remains allows. If that is not
+  enough, the states of the investigated nodes are packed, and if that is not
+  enough either, they are replaced by their signatures. The progress checks
+  are dropped, because they would need the states. */
+#ifdef budget_shrink
+
+/* Moves the states of the nodes from q_first on to follow slots 0 and 1. */
+void st_rebase( node_idx q_first ){
+  unsigned nw = state_var::nr_words;
+  node_idx beg = st_slot( q_first ), end = st_slot( nodes.size() ) + 1;
+  std::vector< unsigned > st( ( end - beg + 2 ) * nw );
+  std::copy(
+    state_var::st_data.begin(), state_var::st_data.begin() + 2 * nw,
+    st.begin()
+  );
+  std::copy(
+    state_var::st_data.begin() + beg * nw,
+    state_var::st_data.begin() + end * nw, st.begin() + 2 * nw
+  );
+  state_var::st_data.swap( st );
+  st_base = q_first; st_off = q_first - 2;
+}
+
+/* Sets stop_count according to the memory that remains, and returns true if
+  construction may continue. */
+bool shrink_room(){
+  #ifdef __GLIBC__
+  malloc_trim( 0 );
+  #endif
+  size_t rss = rss_bytes(), lim = budget_bytes / 20 * 19;
+  if( rss >= lim ){ return false; }
+  size_t room = ( lim - rss ) / budget_per_state(),
+    max_states = nodes.size() + room;
+  if( room <= nr_trans + budget_step ){ return false; }
+  if( max_states > ~node_idx( 0 ) >> 1 ){ max_states = ~node_idx( 0 ) >> 1; }
+  #ifdef stop_cnt
+  if( max_states > stop_cnt ){ max_states = stop_cnt; }
+  #endif
+  if( max_states <= stop_count ){ return false; }
+  stop_count = max_states;
+  state_var::st_data.reserve(
+    ( st_slot( stop_count ) + 2 ) * state_var::nr_words
+  );
+  return true;
+}
+
+/* Makes room for more states, shrinking the states of the nodes below
+  q_first if necessary. Returns true if construction may continue. */
+bool shrink_states( node_idx q_first ){
+  if( shrink_room() ){ return true; }
+  if( q_first <= 2 ){ return false; }
+  #ifndef no_progr_chk
+  budget_no_progr = true;
+  #endif
+  if( !pk_words ){ pk_setup(); }
+
+  /* Pack the states, if that saves memory. */
+  if( pk_words < state_var::nr_words ){
+    pk_data.resize( ( q_first - hc_base ) * pk_words );
+    for( node_idx ni = st_base; ni < q_first; ++ni ){
+      pk_pack( st_slot( ni ), &pk_data[ ( ni - hc_base ) * pk_words ] );
+    }
+    st_rebase( q_first );
+    if( shrink_room() ){ return true; }
+  }
+
+  /* Replace the packed and the other investigated states by signatures. */
+  std::vector< unsigned > pk( pk_words );
+  hc_sig.resize( q_first - 2 );
+  for( node_idx ni = hc_base; ni < q_first; ++ni ){
+    if( ni < st_base ){
+      hc_sig[ ni - 2 ] = hc_sign( &pk_data[ ( ni - hc_base ) * pk_words ] );
+    }else{
+      pk_pack( st_slot( ni ), &pk[0] ); hc_sig[ ni - 2 ] = hc_sign( &pk[0] );
+    }
+  }
+  free_column( pk_data ); hc_base = q_first;
+  if( st_base < q_first ){ st_rebase( q_first ); }
+  return shrink_room();
+}
+#else
+inline bool shrink_states( node_idx ){ return false; }
+#endif
 
 
 #ifdef no_show_cnt
@@ -457,14 +1935,25 @@ const char *clean_eol = "\033[K";
 
 /* Prints the sequence of states from the initial state (or any state with no
   predecessor) to state number ni. */
-void print_history( unsigned ni ){
+void print_history( node_idx ni ){
   if( !ni ){ return; }
-  print_history( nodes[ ni ].prev ); use_state( ni ); model::print_state();
+  #ifdef budget_shrink
+  if( ni > 1 && ni < hc_base ){
+    std::cout << "(The states before this were stored by hash compaction.)\n";
+    return;
+  }
+  print_history( nodes.prev[ ni ] );
+  if( ni > 1 && ni < st_base ){ pk_unpack( ni ); }
+  else{ use_state( ni ); }
+  model::print_state();
+  #else
+  print_history( nodes.prev[ ni ] ); use_state( ni ); model::print_state();
+  #endif
 }
 
 
 /* Reports the error that has been found. */
-void report_error( unsigned ni, const char *msg ){
+void report_error( node_idx ni, const char *msg ){
   static bool reported = false;
   if( reported ){ return; }
   reported = true;
@@ -475,17 +1964,46 @@ void report_error( unsigned ni, const char *msg ){
 }
 
 
-/* Prints a typical sequence of events from node ni. Affects prev and e_cnt.
-  Avoids old states whose e_cnt == 0. */
+/* Checks the not yet violated registered properties of the given kind in
+  node ni, which must be the current state. */
+void check_props( node_idx ni, unsigned kind ){
+  for( unsigned pi = 0; pi < props.size(); ++pi ){
+    prop_type &pr = props[ pi ];
+    if( pr.kind != kind || pr.node ){ continue; }
+    pr.msg = pr.check();
+    if( pr.msg ){ pr.node = ni; }
+  }
+}
+
+/* Reports the violation of a registered property that was found in node ni.
+  With progress properties, the counterexample has already been printed. */
+void report_prop( const prop_type &pr ){
+  static const char *const kind_txt[] = {
+    "Safety error", "Illegal deadlock", "May-type non-progress error",
+    "Must-type non-progress error"
+  };
+  if( pr.kind == prop_st || pr.kind == prop_dl ){
+    std::cout << clean_eol; print_history( pr.node );
+  }
+  std::cout << "!!! " << kind_txt[ pr.kind ] << " [" << pr.name << ']';
+  if( pr.msg && *pr.msg ){ std::cout << ": " << pr.msg; }
+  std::cout << '\n';
+}
+
+
+/* Prints a typical sequence of events from node ni. Affects e_cnt. Avoids
+  old states whose e_cnt == 0. Uses prev temporarily, restoring it at end. */
 #ifdef no_progr_chk
-void print_typical( unsigned, bool ){}
+void print_typical( node_idx, bool ){}
 #else
-void print_typical( unsigned ni, bool no_ins ){
+void print_typical( node_idx ni, bool no_ins ){
+  std::vector< node_idx > old_prev;   // pairs of node and its original prev
 
   /* Find looping state. */
-  unsigned nprev = 0;
+  node_idx nprev = 0;
   do{
-    nodes[ ni ].e_cnt = ~0u; nodes[ ni ].prev = nprev; nprev = ni;
+    old_prev.push_back( ni ); old_prev.push_back( nodes.prev[ ni ] );
+    nodes.e_cnt[ ni ] = ~edge_idx( 0 ); nodes.prev[ ni ] = nprev; nprev = ni;
     fire_init( ni );
     for( unsigned tr = 0; tr < nr_trans; ++tr ){
       if( model::fire_transition( tr ) ){
@@ -495,19 +2013,24 @@ void print_typical( unsigned ni, bool no_ins ){
         if( no_ins ){ ni = hash_find(); }
         else{
           ni = hash_insert();
-          if( hash_was_new ){ nodes[ ni ].e_cnt = 1; }
+          if( hash_was_new ){ nodes.e_cnt[ ni ] = 1; }
         }
-        if( ni && nodes[ ni ].e_cnt ){ tr = nr_trans; }
+        if( ni && nodes.e_cnt[ ni ] ){ tr = nr_trans; }
         else{ ni = nprev; fire_init( ni ); }
       }
       if( err_msg ){ report_error( ni, "Transition firing error" ); return; }
     }
-  }while( nodes[ ni ].e_cnt != ~0u );
+  }while( nodes.e_cnt[ ni ] != ~edge_idx( 0 ) );
 
   /* Print path to loop and the loop. */
-  std::cout << clean_eol; print_history( nodes[ ni ].prev );
+  std::cout << clean_eol; print_history( nodes.prev[ ni ] );
   std::cout << "----------\n";
-  nodes[ ni ].prev = 0; print_history( nprev );
+  nodes.prev[ ni ] = 0; print_history( nprev );
+
+  /* Restore the finding predecessors, for later counterexamples. */
+  for( size_t ii = old_prev.size(); ii; ii -= 2 ){
+    nodes.prev[ old_prev[ ii-2 ] ] = old_prev[ ii-1 ];
+  }
 
 }
 #endif
@@ -529,7 +2052,7 @@ void store_initial_state(){
   #ifdef symmetry
   model::symmetry_representative();
   #endif
-  hash_insert(); nodes[1].prev = 0;
+  hash_insert(); nodes.prev[ 1 ] = 0;
   if( err_msg ){ report_error( 1, "Initialization error" ); return; }
   if( nr_trans == ~0u ){
     err_msg = ""; report_error( 0, "Too many transitions" ); return;
@@ -540,327 +2063,3831 @@ void store_initial_state(){
   err_msg = model::check_state();
   if( err_msg ){ report_error( 1, "Safety error" ); return; }
   #endif
+  #ifdef chk_props
+  check_props( 1, prop_st );
+  #endif
 
 }
 
 
 #ifndef no_progr_chk
 bool bss_second = false;    // first or second firing of transitions
-unsigned *iedges = 0;       // backward edges
+#ifdef packed_edges
+unsigned char *iedges = 0;  // backward edges, packed
+#else
+node_idx *iedges = 0;       // backward edges
+#endif
+#endif
+#ifdef tr_labels
+unsigned *ie_tr = 0;        // the transitions of the backward edges
 #endif
+node_idx bss_first = 1;     // the node from which construction continues
+bool bss_stopped = false;   // construction was stopped because of stop_cnt
+
+
+/* Incoming edges */
+/* The sources of the incoming edges of node ni are listed from ie_end[ ni-1 ]
+  to ie_end[ ni ] - 1 of iedges, and are read via ie_iter. They are in
+  increasing order, because the edges are generated in the order of their
+  source nodes. With packed_edges, the list is a sequence of variable-length
+  numbers of 7 bits per byte, the highest bit telling that more bytes follow.
+  The first number is the difference of the first source from ni, with its
+  sign as the lowest bit, and the others are differences from the previous
+  source. ie_end then counts bytes. The length of each list is first found
+  in e_cnt, and then the list is filled in. nodes.ie_last holds the previous
+  source of each list meanwhile. With packed_sized, the lengths are found
+  during construction, because it generates the edges in the same order as
+  the filling. Otherwise the edges are generated one more time for them. */
+#ifndef no_progr_chk
+#ifdef packed_edges
+bool ie_sizing = false;     // only the lengths of the lists are computed
+
+/* Returns the number that is stored for the edge from n1 to n2. */
+inline unsigned long long ie_code( node_idx n1, node_idx n2 ){
+  node_idx last = nodes.ie_last[ n2 ]; nodes.ie_last[ n2 ] = n1;
+  if( last ){ return n1 - last; }
+  if( n1 < n2 ){ return ( (unsigned long long)( n2 - n1 ) << 1 ) - 1; }
+  return (unsigned long long)( n1 - n2 ) << 1;
+}
 
+/* Returns the number of bytes that the edge from n1 to n2 takes. */
+inline edge_idx ie_bytes( node_idx n1, node_idx n2 ){
+  unsigned long long vv = ie_code( n1, n2 );
+  edge_idx nb = 1;
+  while( vv >>= 7 ){ ++nb; }
+  return nb;
+}
 
-/* Try to fire a transition. If success, process the resulting state and
-  restore the state for firing the next transition. */
-inline bool try_transition( unsigned n1, unsigned tr ){
+/* Adds the edge from n1 to n2 to the list of n2. */
+inline void ie_put( node_idx n1, node_idx n2 ){
+  if( ie_sizing ){ nodes.e_cnt[ n2 ] += ie_bytes( n1, n2 ); return; }
+  unsigned long long vv = ie_code( n1, n2 );
+  edge_idx &ee = nodes.ie_end[ n2 ];
+  for( ; vv >= 128; vv >>= 7 ){ iedges[ ee++ ] = vv | 128; }
+  iedges[ ee++ ] = vv;
+}
 
-  /* Try it, and just return failure if it was disabled. */
-  bool enabled = model::fire_transition( tr );
-  #ifndef no_sanity_chk
-  if( err_msg ){
-    report_error( n1, "Transition firing error" ); return false;
+/* Iterates the sources of the incoming edges of node ni. */
+struct ie_iter{
+  const unsigned char *pp, *end; node_idx src; bool first;
+  ie_iter( node_idx ni ):
+    pp( iedges + nodes.ie_end[ ni-1 ] ), end( iedges + nodes.ie_end[ ni ] ),
+    src( ni ), first( true ) {}
+  inline bool next( node_idx &n1 ){
+    if( pp == end ){ return false; }
+    unsigned long long vv = *pp & 127;
+    for( unsigned sh = 7; *pp++ & 128; sh += 7 ){
+      vv |= (unsigned long long)( *pp & 127 ) << sh;
+    }
+    if( !first ){ src += vv; }
+    else if( vv & 1 ){ src -= ( vv + 1 ) >> 1; first = false; }
+    else{ src += vv >> 1; first = false; }
+    n1 = src; return true;
   }
-  #endif
-  if( !enabled ){ return false; }
+};
+#else
+#ifndef edge_file
 
-  #ifdef symmetry
-  model::symmetry_representative();
-  #endif
+/* Adds the edge from n1 to n2 to the list of n2. */
+inline void ie_put( node_idx n1, node_idx n2 ){
+  iedges[ nodes.ie_end[ n2 ]++ ] = n1;
+}
 
-  #ifndef no_progr_chk
-  if( bss_second ){
-    iedges[ nodes[ hash_find() ].ie_end++ ] = n1;
-    fire_init( n1 ); return true;
+/* Iterates the sources of the incoming edges of node ni. */
+struct ie_iter{
+  edge_idx ei, end;
+  ie_iter( node_idx ni ): ei( nodes.ie_end[ ni-1 ] ), end( nodes.ie_end[ ni ] )
+    {}
+  inline bool next( node_idx &n1 ){
+    if( ei == end ){ return false; }
+    n1 = iedges[ ei++ ]; return true;
   }
-  #endif
-
-  /* Add or find the state and add the edge to it to data structures. */
-  unsigned n2 = hash_insert();
-  ++nr_edges;
-  #ifndef no_progr_chk
-  ++nodes[ n2 ].e_cnt;
-  #endif
-
-  /* If the state is new, record its finding predecessor. */
-  if( hash_was_new ){
-    nodes[ n2 ].prev = n1;
+};
+#endif
+#endif
+#endif
 
-    /* Check that the new state is good. */
-    #ifdef chk_state
-    err_msg = model::check_state();
-    if( err_msg ){ report_error( n2, "Safety error" ); return true; }
-    #endif
 
+/* Incoming edges in files */
+/* With edge_file, the incoming edges are not kept in main memory. The nodes
+  are divided into ranges of ie_range consecutive nodes, and the edges whose
+  target is in a range are appended as source, target pairs to a file of
+  their own. The backward propagations of the progress checks are made by
+  ie_sweep in passes over the files, reading only the files of those ranges
+  that contain nodes waiting to be propagated. Only the counters and marks of
+  the nodes are in main memory. The files are removed as soon as they have
+  been created. */
+#ifdef edge_file
+#ifndef edge_buckets
+#define edge_buckets 64
+#endif
+struct ie_bucket{
+  int fd;                       // the file, or -1 if not yet created
+  std::vector< node_idx > buf;  // pairs not yet written to the file
+  bool dirty;                   // some node of the range is waiting
+  ie_bucket(): fd( -1 ), dirty( false ){}
+};
+std::vector< ie_bucket > ie_files;
+node_idx ie_range = 1;          // number of nodes per file
+const unsigned ie_buf_max = 1u << 14;
+std::vector< node_idx > ie_rbuf;        // buffer for reading the files
+std::vector< unsigned char > ie_mark;   // bit 7: waiting, others: scanned
+
+/* Creates the files for the edges of nodes 0, ..., nn-1. */
+void ie_open( node_idx nn ){
+  ie_range = nn / edge_buckets + 1;
+  ie_files.resize( ( nn + ie_range - 1 ) / ie_range );
+  for( unsigned bi = 0; bi < ie_files.size(); ++bi ){
+    char name[ 4096 ];
+    std::snprintf( name, sizeof( name ), "%s.%u", edge_file, bi );
+    ie_bucket &bk = ie_files[ bi ];
+    bk.fd = open( name, O_RDWR | O_CREAT | O_TRUNC, 0600 );
+    if( bk.fd < 0 ){ err_msg = "Cannot create edge_file"; return; }
+    unlink( name ); bk.buf.reserve( ie_buf_max );
   }
-
-  /* Restore the state to try the next transition, and report success. */
-  fire_init( n1 ); return true;
-
+  ie_rbuf.resize( ie_buf_max ); ie_mark.assign( nn, 0 );
 }
 
+/* Writes the buffered pairs of bk to its file. */
+void ie_flush( ie_bucket &bk ){
+  size_t nn = sizeof( node_idx ) * bk.buf.size();
+  if( nn && write( bk.fd, &bk.buf[0], nn ) != ssize_t( nn ) ){
+    if( !err_msg ){ err_msg = "Cannot write edge_file"; }
+  }
+  bk.buf.clear();
+}
 
-/* Constructs the state space, detecting safety and deadlock errors. */
-void build_state_space(){
-  #ifndef no_show_cnt
-  const char *progress_msg = " states constructed\n\033[F";
-  #ifndef no_progr_chk
-  if( bss_second ){ progress_msg = " states backwards-processed\n\033[F"; }
-  #endif
-  #endif
+/* Closes and forgets the files. */
+void ie_close(){
+  for( unsigned bi = 0; bi < ie_files.size(); ++bi ){
+    if( ie_files[ bi ].fd >= 0 ){ close( ie_files[ bi ].fd ); }
+  }
+  ie_files.clear(); free_column( ie_rbuf ); free_column( ie_mark );
+}
 
-  /* Variables for finding stubborn sets */
-  #ifdef stubborn
-  unsigned
-    *stub_try = new unsigned[ nr_trans ],   // transition tried in the node
-    *stub_found = new unsigned[ nr_trans ], stub_nr = -1u,  // found "bit"
-    *stub_dfs = new unsigned[ nr_trans ], dfs_cnt = 0,  // DFS stack
-    *stub_scc = new unsigned[ nr_trans ], scc_cnt = 0,  // Tarjan's SCC stack
-    *stub_min = new unsigned[ nr_trans ];   // backward-propagated node number
-  #endif
+/* Adds the edge from n1 to n2 to the file of n2. */
+inline void ie_put( node_idx n1, node_idx n2 ){
+  ie_bucket &bk = ie_files[ n2 / ie_range ];
+  bk.buf.push_back( n1 ); bk.buf.push_back( n2 );
+  if( bk.buf.size() >= ie_buf_max ){ ie_flush( bk ); }
+}
 
-  /* Investigate states in breadth-first order until the queue is empty. */
-  for( unsigned q_first = 1; q_first < nodes.size(); ++q_first ){
-    unsigned old_edges = nr_edges;  // for detecting terminal states
+/* Reads the next pairs of bk from position pos to ie_rbuf, and returns the
+  number of node numbers read. */
+size_t ie_read( ie_bucket &bk, off_t &pos ){
+  ssize_t nn =
+    pread( bk.fd, &ie_rbuf[0], sizeof( node_idx ) * ie_buf_max, pos );
+  if( nn < 0 ){ err_msg = "Cannot read edge_file"; return 0; }
+  pos += nn; return size_t( nn ) / sizeof( node_idx );
+}
 
-    /* Occasionally show the number of processed states. */
-    #ifndef no_show_cnt
-    if( q_first % show_count == 0 ){
-      std::cout << q_first << progress_msg; std::cout.flush();
+/* Calls edge( n1, n2 ) for every edge from n1 to n2. */
+template< class Fn > void ie_all( Fn edge ){
+  for( unsigned bi = 0; bi < ie_files.size(); ++bi ){
+    off_t pos = 0;
+    while( size_t nn = ie_read( ie_files[ bi ], pos ) ){
+      for( size_t ii = 0; ii < nn; ii += 2 ){
+        edge( ie_rbuf[ ii ], ie_rbuf[ ii + 1 ] );
+      }
     }
-    #endif
+  }
+}
 
-    /* Employ an "enabled was found" bit and a fresh "found"-number. */
-    #ifdef stubborn
-    bool some_fired = false;
-    ++stub_nr;
-    if( !stub_nr ){
-      for( unsigned tr = 0; tr < nr_trans; ++tr ){ stub_found[ tr ] = 0; }
-      ++stub_nr;
+/* Marks node ni as waiting to be propagated to its predecessors. */
+inline void ie_queue( node_idx ni ){
+  if( ie_mark[ ni ] & 128 ){ return; }
+  ie_mark[ ni ] |= 128; ie_files[ ni / ie_range ].dirty = true;
+}
+
+/* Propagates backwards until no node is waiting. When the file of a range is
+  read, take( ni ) is called for each waiting node ni in the range, and then
+  edge( n1, code ) for each edge from n1 to such a node, where code is what
+  take returned for it (1 to 127). Nodes that are queued meanwhile are taken
+  when the file of their range is read the next time. */
+template< class Tk, class Fn > void ie_sweep( Tk take, Fn edge ){
+  for( bool more = true; more && !err_msg; ){
+    more = false;
+    for( unsigned bi = 0; bi < ie_files.size(); ++bi ){
+      ie_bucket &bk = ie_files[ bi ];
+      if( !bk.dirty ){ continue; }
+      bk.dirty = false; more = true;
+      node_idx lo = bi * ie_range, hi = lo + ie_range;
+      if( hi > ie_mark.size() ){ hi = ie_mark.size(); }
+      for( node_idx ni = lo; ni < hi; ++ni ){
+        if( ie_mark[ ni ] & 128 ){ ie_mark[ ni ] = take( ni ) & 127; }
+      }
+      off_t pos = 0;
+      while( size_t nn = ie_read( bk, pos ) ){
+        for( size_t ii = 0; ii < nn; ii += 2 ){
+          unsigned char code = ie_mark[ ie_rbuf[ ii + 1 ] ] & 127;
+          if( code ){ edge( ie_rbuf[ ii ], code ); }
+        }
+      }
+      for( node_idx ni = lo; ni < hi; ++ni ){ ie_mark[ ni ] &= 128; }
     }
-    #endif
+  }
+}
+#endif
 
-    /* Try all transitions as such or as starting points of a stubborn set. */
-    fire_init( q_first );
-    #ifdef try_forward
-    for( unsigned tr = 0; tr < nr_trans; ++tr ){
-    #else
-    for( unsigned tr = nr_trans; tr--; ){
-    #endif
 
-      #ifndef stubborn
-      try_transition( q_first, tr );
-      if( err_msg ){ return; }
+/* Export of the state space */
+/* With lts_file, the file starts with the characters "ASSETlts" and the
+  32-bit version of the format, fingerprint of the layout of the state
+  variables, number of words per state, and number of transitions. Then come
+  the words of the initial state, which is state number 1. Then each edge is
+  given as the increase of its source state number from the previous edge,
+  its transition number, and its target state number, each as a number of 7
+  bits per byte, least significant first. The increase is modulo the range of
+  node_idx, because with best_first, a_star, or beam_width, the source state
+  numbers need not grow. If the target is a new state, the
+  edge is followed by the words of the state. The states are numbered in the
+  order in which they are found. With aut_file, state i is numbered i-1. */
+#ifdef lts_file
+#define lts_out
+#endif
+#ifdef aut_file
+#define lts_out
+#endif
+#ifdef lts_input
+#undef lts_out
+#endif
+const unsigned lts_version = 1;
 
-      #else
+#ifdef lts_out
+
+/* A file that is written via a buffer */
+class out_file{
+  int fd;
+  std::vector< char > buf;
+public:
+  out_file(): fd( -1 ){}
+  bool create( const char *name ){
+    fd = open( name, O_WRONLY | O_CREAT | O_TRUNC, 0644 ); return fd >= 0;
+  }
+  void flush(){
+    if(
+      fd >= 0 && !buf.empty() &&
+      write( fd, &buf[0], buf.size() ) != ssize_t( buf.size() )
+    ){ err_msg = "Cannot write export file"; }
+    buf.clear();
+  }
+  inline void put( const void *pp, size_t nn ){
+    const char *cp = (const char *)pp; buf.insert( buf.end(), cp, cp + nn );
+    if( buf.size() >= 1u << 16 ){ flush(); }
+  }
+  inline void put_num( unsigned long long val ){
+    for( ; val >= 128; val >>= 7 ){
+      buf.push_back( char( ( val & 127 ) | 128 ) );
+    }
+    buf.push_back( char( val ) );
+    if( buf.size() >= 1u << 16 ){ flush(); }
+  }
+  void put_at( off_t pos, const void *pp, size_t nn ){
+    if( fd >= 0 && pwrite( fd, pp, nn, pos ) != ssize_t( nn ) ){
+      err_msg = "Cannot write export file";
+    }
+  }
+  void finish(){ flush(); if( fd >= 0 ){ close( fd ); fd = -1; } }
+};
+
+#ifdef lts_file
+out_file lts_out_file;
+node_idx lts_src = 0;       // the source state of the previous edge
+#endif
+#ifdef aut_file
+out_file aut_out_file;
+#endif
+
+/* Writes the header of the Aldebaran file, of fixed width so that the final
+  numbers can be written over it. */
+#ifdef aut_file
+void aut_head( bool at_end ){
+  char line[80];
+  int nn = std::snprintf(
+    line, sizeof( line ), "des (0, %20llu, %20llu)\n",
+    (unsigned long long)nr_edges, (unsigned long long)( nodes.size() - 1 )
+  );
+  if( at_end ){ aut_out_file.put_at( 0, line, nn ); }
+  else{ aut_out_file.put( line, nn ); }
+}
+#endif
+
+/* Creates the export files and writes the initial state. */
+void lts_open(){
+  #ifdef lts_file
+  if( !lts_out_file.create( lts_file ) ){
+    err_msg = "Cannot create lts_file"; return;
+  }
+  unsigned hd[4] = {
+    lts_version, state_var::layout(), state_var::nr_words, nr_trans
+  };
+  lts_out_file.put( "ASSETlts", 8 ); lts_out_file.put( hd, sizeof( hd ) );
+  lts_out_file.put(
+    &state_var::st_data[ state_var::nr_words ],
+    sizeof( unsigned ) * state_var::nr_words
+  );
+  #endif
+  #ifdef aut_file
+  if( !aut_out_file.create( aut_file ) ){
+    err_msg = "Cannot create aut_file"; return;
+  }
+  aut_head( false );
+  #endif
+}
+
+/* Writes the edge from n1 via tr to n2, and n2 if it is new. */
+inline void lts_edge( node_idx n1, unsigned tr, node_idx n2 ){
+  #ifdef lts_file
+  lts_out_file.put_num( n1 - lts_src ); lts_src = n1;
+  lts_out_file.put_num( tr ); lts_out_file.put_num( n2 );
+  if( hash_was_new ){
+    lts_out_file.put(
+      &state_var::st_data[ st_slot( n2 ) * state_var::nr_words ],
+      sizeof( unsigned ) * state_var::nr_words
+    );
+  }
+  #endif
+  #ifdef aut_file
+  char line[80];
+  int nn = std::snprintf(
+    line, sizeof( line ), "(%llu,\"t%u\",%llu)\n",
+    (unsigned long long)( n1 - 1 ), tr, (unsigned long long)( n2 - 1 )
+  );
+  aut_out_file.put( line, nn );
+  #endif
+}
+
+/* Completes the export files. */
+void lts_close(){
+  #ifdef lts_file
+  lts_out_file.finish();
+  #endif
+  #ifdef aut_file
+  aut_out_file.flush(); aut_head( true ); aut_out_file.finish();
+  #endif
+}
+
+#endif
+
+
+/* Declared variables of the transitions */
+/* For each transition, the words and masks of the variables that it reads or
+  writes (the key) and of those that it writes are recorded. The last set is
+  for the variables that check_state reads. A set with no key is empty, that
+  is, nothing was declared. */
+#ifdef tr_decls
+struct var_set{
+  std::vector< unsigned > kw, km;   // words and masks of the key
+  std::vector< unsigned > ww, wm;   // words and masks of the written bits
+};
+std::vector< var_set > tr_sets;
+unsigned tr_decl_cur = ~0u;         // the set being declared
+
+/* Adds the bits to the list of words and masks, merging words. */
+void var_set_add(
+  std::vector< unsigned > &words, std::vector< unsigned > &masks,
+  unsigned word, unsigned mask
+){
+  for( unsigned ii = 0; ii < words.size(); ++ii ){
+    if( words[ ii ] == word ){ masks[ ii ] |= mask; return; }
+  }
+  words.push_back( word ); masks.push_back( mask );
+}
+
+void tr_decl( unsigned word, unsigned mask, bool write ){
+  if( tr_decl_cur >= tr_sets.size() ){
+    err_msg = "rd() or wr() called outside transition_vars()"; return;
+  }
+  var_set &vs = tr_sets[ tr_decl_cur ];
+  var_set_add( vs.kw, vs.km, word, mask );
+  if( write ){ var_set_add( vs.ww, vs.wm, word, mask ); }
+}
+
+/* Asks the model for the variables of each transition and of check_state,
+  in the initial state. */
+void tr_sets_setup(){
+  tr_sets.assign( nr_trans + 1, var_set() );
+  #ifdef tr_vars
+  for( tr_decl_cur = 0; tr_decl_cur < nr_trans; ++tr_decl_cur ){
+    use_state( 1 ); model::transition_vars( tr_decl_cur );
+  }
+  #endif
+  #ifdef state_vars
+  tr_decl_cur = nr_trans; use_state( 1 ); model::check_state_vars();
+  #endif
+  tr_decl_cur = ~0u;
+}
+#else
+void tr_decl( unsigned, unsigned, bool ){}
+#endif
+
+
+/* Transition result cache */
+/* The results of firing a transition are kept in a direct-mapped table per
+  transition, indexed by a hash of the values of its key. An entry consists
+  of a tag (0 = empty, 1 = disabled, 2 = enabled), the key, and the new
+  values of the written bits. A transition that declares no variables is not
+  cached. Without no_sanity_chk, it is checked after each real firing that no
+  undeclared bits changed, and every cache_chk_mask + 1st hit is compared
+  against a real firing, to catch undeclared reads. */
+#ifdef tr_cache
+const unsigned cache_bits = tr_cache, cache_chk_mask = 4095;
+
+struct cache_tr{
+  std::vector< unsigned > tab;      // the entries
+  unsigned ent_sz;                  // number of words in an entry
+};
+std::vector< cache_tr > cache;
+unsigned long long cache_hits = 0, cache_misses = 0;
+std::vector< unsigned > cache_old, cache_real; // copies for sanity checks
+
+/* Allocates the tables of the transitions that declared their variables. */
+void cache_setup(){
+  tr_sets_setup();
+  cache.resize( nr_trans );
+  for( unsigned tr = 0; tr < nr_trans; ++tr ){
+    const var_set &vs = tr_sets[ tr ];
+    if( vs.kw.empty() ){ continue; }
+    cache[ tr ].ent_sz = 1 + vs.kw.size() + vs.ww.size();
+    cache[ tr ].tab.assign( cache[ tr ].ent_sz << cache_bits, 0 );
+  }
+}
+
+/* Fires transition tr in the current state, using the cache if possible.
+  The sanity checks are made if chk. */
+template< bool chk > inline bool fire_cached( unsigned tr ){
+  const var_set &ct = tr_sets[ tr ];
+  if( ct.kw.empty() ){ return model::fire_transition( tr ); }
+  unsigned nr_words = state_var::nr_words,
+    *st = &state_var::st_data[ state_var::state_nr * nr_words ];
+  unsigned nk = ct.kw.size(), nw = ct.ww.size(), hh = tr;
+  for( unsigned ii = 0; ii < nk; ++ii ){
+    hh = ( hh ^ ( st[ ct.kw[ ii ] ] & ct.km[ ii ] ) ) * 0x9e3779b1u;
+    hh ^= hh >> 16;
+  }
+  unsigned *ent = &cache[ tr ].tab[
+    ( hh & ( ( 1u << cache_bits ) - 1 ) ) * cache[ tr ].ent_sz
+  ];
+
+  /* Use the entry, if it is for the same key. */
+  bool hit = ent[0];
+  for( unsigned ii = 0; hit && ii < nk; ++ii ){
+    hit = ent[ 1 + ii ] == ( st[ ct.kw[ ii ] ] & ct.km[ ii ] );
+  }
+  if( hit ){
+    ++cache_hits;
+    #ifndef no_sanity_chk
+    bool cmp = chk && !( cache_hits & cache_chk_mask ), real_en = false;
+    if( cmp ){
+      cache_old.assign( st, st + nr_words );
+      real_en = model::fire_transition( tr );
+      cache_real.assign( st, st + nr_words );
+      std::memcpy( st, &cache_old[0], nr_words * sizeof( unsigned ) );
+      if( err_msg ){ return real_en; }
+    }
+    #endif
+    bool en = ent[0] == 2;
+    if( en ){
+      for( unsigned ii = 0; ii < nw; ++ii ){
+        st[ ct.ww[ ii ] ] =
+          ( st[ ct.ww[ ii ] ] & ~ct.wm[ ii ] ) | ent[ 1 + nk + ii ];
+      }
+    }
+    #ifndef no_sanity_chk
+    if(
+      cmp && ( en != real_en ||
+        std::memcmp( st, &cache_real[0], nr_words * sizeof( unsigned ) ) )
+    ){ err_msg = "A transition reads a variable that it did not declare"; }
+    #endif
+    return en;
+  }
+
+  /* Otherwise fire the transition and store the result in the entry. */
+  ++cache_misses;
+  ent[0] = 0;
+  for( unsigned ii = 0; ii < nk; ++ii ){
+    ent[ 1 + ii ] = st[ ct.kw[ ii ] ] & ct.km[ ii ];
+  }
+  #ifndef no_sanity_chk
+  if( chk ){ cache_old.assign( st, st + nr_words ); }
+  #endif
+  bool en = model::fire_transition( tr );
+  if( err_msg ){ return en; }
+  for( unsigned ii = 0; ii < nw; ++ii ){
+    ent[ 1 + nk + ii ] = st[ ct.ww[ ii ] ] & ct.wm[ ii ];
+  }
+  #ifndef no_sanity_chk
+  if( chk && en ){
+    for( unsigned ii = 0; ii < nw; ++ii ){
+      cache_old[ ct.ww[ ii ] ] &= ~ct.wm[ ii ];
+      cache_old[ ct.ww[ ii ] ] |= ent[ 1 + nk + ii ];
+    }
+  }
+  if(
+    chk && std::memcmp( st, &cache_old[0], nr_words * sizeof( unsigned ) )
+  ){
+    err_msg = "A transition wrote a variable that it did not declare";
+    return en;
+  }
+  #endif
+  ent[0] = en ? 2 : 1;
+  return en;
+}
+#endif
+
+
+/* Directed search */
+/* With best_first, a_star, or beam_width, the states that wait for being
+  investigated are kept in a priority queue instead of investigating the nodes
+  in the order of their numbers. Its key is distance() of the state, possibly
+  preceded by or added to the depth of the state, that is, the length of the
+  path via finding predecessors. Ties are broken by the node number. The
+  initial state is investigated first without being in the queue. With
+  beam_width, the key puts the levels in order, so each level is complete
+  before its first state is taken, and the rest of it can be dropped. */
+#ifdef directed
+struct dir_entry{
+  unsigned long long key; node_idx ni;
+  bool operator<( const dir_entry &de ) const {
+    return key > de.key || ( key == de.key && ni > de.ni );
+  }
+};
+std::vector< dir_entry > dir_queue;   // heap, the smallest entry first
+#ifndef best_first
+std::vector< unsigned > dir_depth( 2 );   // the depths of the nodes
+#endif
+#ifdef a_star
+std::vector< char > dir_closed( 2, 1 );   // the node has been investigated
+#endif
+#ifdef beam_width
+unsigned dir_level = 0, dir_taken = 1;  // the current level and its size
+node_idx dir_dropped = 0;               // number of dropped states
+#endif
+
+/* Puts the new node n2, which is the current state, to the queue. n1 is its
+  finding predecessor. */
+#ifdef best_first
+inline void dir_push( node_idx, node_idx n2 ){
+#else
+inline void dir_push( node_idx n1, node_idx n2 ){
+#endif
+  unsigned long long key = model::distance();
+  #ifndef best_first
+  if( dir_depth.size() <= n2 ){ dir_depth.resize( n2 + 1 ); }
+  #ifdef a_star
+  if( dir_closed.size() <= n2 ){ dir_closed.resize( n2 + 1 ); }
+  #endif
+  dir_depth[ n2 ] = dir_depth[ n1 ] + 1;
+  #ifdef a_star
+  key += dir_depth[ n2 ];
+  #else
+  key |= (unsigned long long)( dir_depth[ n2 ] ) << 32;
+  #endif
+  #endif
+  dir_entry de = { key, n2 }; dir_queue.push_back( de );
+  std::push_heap( dir_queue.begin(), dir_queue.end() );
+}
+
+/* With a_star, gives the old node n2, which is the current state, the path
+  via n1, if it is shorter and n2 has not yet been investigated. The entry of
+  the longer path stays in the queue, and is skipped when taken. */
+#ifdef a_star
+inline void dir_improve( node_idx n1, node_idx n2 ){
+  if( dir_closed[ n2 ] || dir_depth[ n1 ] + 1 >= dir_depth[ n2 ] ){ return; }
+  nodes.prev[ n2 ] = n1; dir_push( n1, n2 );
+}
+#endif
+
+/* Returns the node to investigate after ni, or nodes.size() if there is
+  none. */
+#ifdef no_progr_chk
+inline node_idx bss_next( node_idx ){
+#else
+inline node_idx bss_next( node_idx ni ){
+  if( bss_second ){ return ni + 1; }
+#endif
+  while( !dir_queue.empty() ){
+    std::pop_heap( dir_queue.begin(), dir_queue.end() );
+    dir_entry de = dir_queue.back(); dir_queue.pop_back();
+    #ifdef a_star
+    if( dir_closed[ de.ni ] ){ continue; }
+    dir_closed[ de.ni ] = 1;
+    #endif
+    #ifdef beam_width
+    if( de.key >> 32 != dir_level ){ dir_level = de.key >> 32; dir_taken = 0; }
+    if( dir_taken >= beam_width ){ ++dir_dropped; continue; }
+    ++dir_taken;
+    #endif
+    return de.ni;
+  }
+  return nodes.size();
+}
+#endif
+
+
+/* Telemetry */
+/* With telemetry, a background thread writes a line of statistics every
+  telem_ms milliseconds and when construction is ready. build_state_space
+  only stores its counters to atomic variables without ordering constraints,
+  so the thread never makes it wait. The line consists of "key=value" fields:
+  the elapsed time, the numbers of investigated and found states and of edges
+  and their rates per second since the previous line, the length of the
+  queue, the breadth-first level, the load of the hash table, the resident
+  set size, and an estimate of the remaining time of construction. The
+  estimate assumes that the queue will shrink level by level in the ratio of
+  the sizes of the last two complete levels, and is "-" if it grows. */
+#ifdef telemetry
+#ifdef telem_ms
+const unsigned tel_interval = telem_ms;
+#else
+const unsigned tel_interval = 1000;
+#endif
+std::atomic< unsigned long long >
+  tel_done( 0 ), tel_found( 0 ), tel_edges( 0 ),  // the counters
+  tel_depth( 0 ), tel_last( 0 ), tel_prev( 0 );   // level and level sizes
+std::atomic< bool > tel_ready( false );   // construction is ready
+std::thread tel_thread;
+std::mutex tel_mutex;
+std::condition_variable tel_cv;
+bool tel_quit = false;                    // protected by tel_mutex
+node_idx tel_beg = 1, tel_end = 2;        // the current level
+
+/* Writes one line. */
+void tel_line(
+  std::FILE *out, double secs, double dt, unsigned long long &done0,
+  unsigned long long &edges0
+){
+  unsigned long long
+    done = tel_done.load( std::memory_order_relaxed ),
+    found = tel_found.load( std::memory_order_relaxed ),
+    edges = tel_edges.load( std::memory_order_relaxed ),
+    last = tel_last.load( std::memory_order_relaxed ),
+    prev = tel_prev.load( std::memory_order_relaxed ),
+    queue = found > done ? found - done : 0;
+  double rate = dt > 0 ? ( done - done0 ) / dt : 0;
+  std::fprintf( out,
+    "t=%.1f phase=%s done=%llu found=%llu edges=%llu done/s=%.0f"
+    " edges/s=%.0f queue=%llu depth=%llu load=%.3f rss=%lluM eta=",
+    secs, tel_ready ? "ready" : "construct", done, found, edges, rate,
+    dt > 0 ? ( edges - edges0 ) / dt : 0., queue,
+    tel_depth.load( std::memory_order_relaxed ),
+    double( found ) / double( hash_size ),
+    (unsigned long long)( rss_bytes() >> 20 )
+  );
+  if( tel_ready ){ std::fprintf( out, "0s\n" ); }
+  else if( prev && last < prev && rate > 0 ){
+    double left = queue / ( 1. - double( last ) / prev );
+    std::fprintf( out, "%.0fs\n", left / rate );
+  }else{ std::fprintf( out, "-\n" ); }
+  std::fflush( out ); done0 = done; edges0 = edges;
+}
+
+/* The body of the background thread */
+void tel_run(){
+  std::FILE *out = stderr;
+  if( std::strcmp( telemetry, "-" ) ){ out = std::fopen( telemetry, "a" ); }
+  if( !out ){ return; }
+  typedef std::chrono::steady_clock clock;
+  clock::time_point t0 = clock::now(), t1 = t0;
+  unsigned long long done0 = 0, edges0 = 0;
+  std::unique_lock< std::mutex > lock( tel_mutex );
+  for( bool quit = false; !quit; ){
+    quit = tel_cv.wait_for(
+      lock, std::chrono::milliseconds( tel_interval ), []{ return tel_quit; }
+    );
+    clock::time_point t2 = clock::now();
+    tel_line( out,
+      std::chrono::duration< double >( t2 - t0 ).count(),
+      std::chrono::duration< double >( t2 - t1 ).count(), done0, edges0
+    );
+    t1 = t2;
+  }
+  if( out != stderr ){ std::fclose( out ); }
+}
+
+/* Called by build_state_space before investigating node q_first. */
+#ifdef directed
+inline void tel_publish( node_idx ){
+  const std::memory_order rlx = std::memory_order_relaxed;
+  tel_done.store( nodes.size() - 1 - dir_queue.size(), rlx );
+#else
+inline void tel_publish( node_idx q_first ){
+  const std::memory_order rlx = std::memory_order_relaxed;
+  if( q_first >= tel_end ){
+    tel_prev.store( tel_last.load( rlx ), rlx );
+    tel_last.store( tel_end - tel_beg, rlx );
+    tel_depth.store( tel_depth.load( rlx ) + 1, rlx );
+    tel_beg = tel_end; tel_end = nodes.size();
+  }
+  tel_done.store( q_first - 1, rlx );
+#endif
+  tel_found.store( nodes.size() - 1, rlx ); tel_edges.store( nr_edges, rlx );
+}
+
+/* Starts and stops the thread. */
+void tel_start(){
+  tel_beg = bss_first; tel_end = bss_first + 1;
+  tel_thread = std::thread( tel_run );
+}
+void tel_finish(){
+  if( !tel_thread.joinable() ){ return; }
+  tel_found = nodes.size() - 1; tel_edges = nr_edges;
+  if( !err_msg ){ tel_done = nodes.size() - 1; }
+  tel_ready = true;
+  { std::lock_guard< std::mutex > lock( tel_mutex ); tel_quit = true; }
+  tel_cv.notify_one(); tel_thread.join();
+}
+#endif
+
+
+/* Profiling of the model */
+/* With profile, the time spent in fire_transition, next_stubborn,
+  check_state, and symmetry_representative is added up per transition, in
+  processor clock ticks where available. The time of check_state and
+  symmetry_representative is charged to the transition that led to the
+  state. To keep the overhead low, a pseudo-random one in prof_period
+  firings is timed, together with the calls that follow it, and the times are
+  scaled up at the end. The numbers of calls are exact. The second firing of
+  transitions, which makes the incoming edges, is neither counted nor timed.
+  At the end, the rows of the most expensive transitions are printed, the
+  most expensive first. */
+#ifdef profile
+struct prof_tr{
+  unsigned long long fire, en, dis;   // ticks in firing, enabled, disabled
+  unsigned long long stub, stubs;     // ticks in next_stubborn, calls
+  unsigned long long check, news;     // ticks in check_state, new states
+  unsigned long long symm;            // ticks in symmetry_representative
+  unsigned long long total() const { return fire + stub + check + symm; }
+};
+std::vector< prof_tr > prof;
+const unsigned prof_period = 16;  // a power of 2
+unsigned prof_seed = 1;         // for choosing the timed calls
+
+/* Tells whether the calls are counted, that is, this is the first firing. */
+inline bool prof_counted(){
+  #ifdef no_progr_chk
+  return true;
+  #else
+  return !bss_second;
+  #endif
+}
+
+/* Tells whether the next call is timed. */
+inline bool prof_timed(){
+  prof_seed = prof_seed * 1103515245u + 12345u;
+  return !( prof_seed >> 16 & ( prof_period - 1 ) );
+}
+
+inline unsigned long long prof_now(){
+  #ifdef __x86_64__
+  return __rdtsc();
+  #else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+  #endif
+}
+
+/* Sorts transitions by decreasing total time. */
+struct prof_more{
+  bool operator()( unsigned t1, unsigned t2 ) const {
+    return prof[ t1 ].total() > prof[ t2 ].total();
+  }
+};
+
+/* Prints the table. */
+void prof_report(){
+  std::vector< unsigned > ord;
+  unsigned long long sum = 0;
+  for( unsigned tr = 0; tr < prof.size(); ++tr ){
+    if( prof[ tr ].en + prof[ tr ].dis + prof[ tr ].stubs ){
+      ord.push_back( tr ); sum += prof[ tr ].total();
+    }
+  }
+  if( ord.empty() ){ return; }
+  std::stable_sort( ord.begin(), ord.end(), prof_more() );
+  if( ord.size() > unsigned( profile ) ){ ord.resize( profile ); }
+  std::cout << "Profile (ticks per call):\n"
+    << "     tr   share    enabled   disabled   fire   stubs   stub  check"
+    << "   symm\n";
+  for( unsigned ii = 0; ii < ord.size(); ++ii ){
+    prof_tr pt = prof[ ord[ ii ] ];
+    unsigned long long fires = pt.en + pt.dis;
+    pt.fire *= prof_period; pt.stub *= prof_period;
+    pt.check *= prof_period; pt.symm *= prof_period;
+    std::printf(
+      "%7u %6.2f%% %10llu %10llu %6llu %7llu %6llu %6llu %6llu\n",
+      ord[ ii ], sum ? 100.0 * prof[ ord[ ii ] ].total() / sum : 0.0,
+      pt.en, pt.dis,
+      fires ? pt.fire / fires : 0, pt.stubs,
+      pt.stubs ? pt.stub / pt.stubs : 0, pt.news ? pt.check / pt.news : 0,
+      pt.en ? pt.symm / pt.en : 0
+    );
+  }
+  std::fflush( stdout );
+}
+#endif
+
+
+/* Try to fire a transition. If success, process the resulting state and
+  restore the state for firing the next transition. The sanity checks of
+  tr_cache are made if chk. */
+template< bool chk > inline bool try_firing( node_idx n1, unsigned tr ){
+
+  /* Try it, and just return failure if it was disabled. */
+  #ifdef profile
+  bool counted = prof_counted(), timed = counted && prof_timed();
+  unsigned long long p0 = timed ? prof_now() : 0;
+  #endif
+  #ifdef tr_cache
+  bool enabled = fire_cached< chk >( tr );
+  #else
+  bool enabled = model::fire_transition( tr );
+  #endif
+  #ifdef profile
+  if( timed ){ prof[ tr ].fire += prof_now() - p0; }
+  if( counted ){ ++( enabled ? prof[ tr ].en : prof[ tr ].dis ); }
+  #endif
+  #ifndef no_sanity_chk
+  if( err_msg ){
+    report_error( n1, "Transition firing error" ); return false;
+  }
+  #endif
+  if( !enabled ){ return false; }
+
+  #ifdef symmetry
+  #ifdef profile
+  if( timed ){ p0 = prof_now(); }
+  #endif
+  model::symmetry_representative();
+  #ifdef profile
+  if( timed ){ prof[ tr ].symm += prof_now() - p0; }
+  #endif
+  #endif
+
+  #ifndef no_progr_chk
+  if( bss_second ){
+    #ifdef tr_labels
+    edge_idx ei = nodes.ie_end[ hash_find() ]++;
+    iedges[ ei ] = n1; ie_tr[ ei ] = tr;
+    #else
+    ie_put( n1, hash_find() );
+    #endif
+    fire_init( n1 ); return true;
+  }
+  #endif
+
+  /* Add or find the state and add the edge to it to data structures. */
+  node_idx n2 = hash_insert();
+  #ifdef lts_out
+  if( !err_msg ){ lts_edge( n1, tr, n2 ); }
+  #endif
+  ++nr_edges;
+  #ifdef packed_sized
+  if( !err_msg ){ nodes.e_cnt[ n2 ] += ie_bytes( n1, n2 ); }
+  #else
+  #ifndef no_progr_chk
+  ++nodes.e_cnt[ n2 ];
+  #endif
+  #endif
+
+  /* If the state is new, record its finding predecessor. */
+  if( hash_was_new ){
+    nodes.prev[ n2 ] = n1;
+
+    /* Check that the new state is good. */
+    #ifdef chk_state
+    #ifdef profile
+    if( timed ){ p0 = prof_now(); }
+    #endif
+    err_msg = model::check_state();
+    #ifdef profile
+    if( timed ){ prof[ tr ].check += prof_now() - p0; }
+    ++prof[ tr ].news;
+    #endif
+    if( err_msg ){ report_error( n2, "Safety error" ); return true; }
+    #endif
+    #ifdef chk_props
+    check_props( n2, prop_st );
+    #endif
+
+    /* Put it in the queue of the directed search. */
+    #ifdef directed
+    dir_push( n1, n2 );
+    #endif
+
+  }
+  #ifdef a_star
+  else{ dir_improve( n1, n2 ); }
+  #endif
+
+  /* Restore the state to try the next transition, and report success. */
+  fire_init( n1 ); return true;
+
+}
+
+/* Tells whether the sanity checks are made in the current state. With
+  warm_up, it is switched off after the warm-up, except in the sample. */
+#ifdef warm_up
+bool sanity_on = true;
+#endif
+
+/* Tries to fire a transition with or without the sanity checks. */
+inline bool try_transition( node_idx n1, unsigned tr ){
+  #ifdef warm_up
+  if( !sanity_on ){ return try_firing< false >( n1, tr ); }
+  #endif
+  return try_firing< true >( n1, tr );
+}
+
+/* Decides whether the sanity checks are made in node ni. After the first
+  warm_up nodes, they are made in a pseudo-random one of warm_sample nodes,
+  if warm_sample is given. */
+#ifdef warm_up
+inline void sanity_choose( node_idx ni ){
+  sanity_on = ni <= node_idx( warm_up );
+  #ifdef warm_sample
+  unsigned hh = unsigned( ni ) * 0x9e3779b1u;
+  if( ( hh ^ hh >> 16 ) % unsigned( warm_sample ) == 0 ){ sanity_on = true; }
+  #endif
+}
+#endif
+
+
+/* Finding stubborn sets */
+/* stub_search is shared by build_state_space and verify_dfs. A transition
+  has been tried in the current state, if its stub_found is stub_nr, which
+  stub_fresh makes new for each state. */
+#ifdef stubborn
+unsigned
+  *stub_try = 0,                    // transition tried in the node
+  *stub_found = 0, stub_nr = -1u,   // found "bit"
+  *stub_dfs = 0,                    // DFS stack
+  *stub_scc = 0,                    // Tarjan's SCC stack
+  *stub_min = 0;                    // backward-propagated node number
+
+/* Releases and allocates the arrays. */
+void stub_free(){
+  delete [] stub_try; delete [] stub_found; delete [] stub_dfs;
+  delete [] stub_scc; delete [] stub_min;
+  stub_try = stub_found = stub_dfs = stub_scc = stub_min = 0;
+}
+void stub_alloc(){
+  stub_free();
+  stub_try = new unsigned[ nr_trans ]; stub_found = new unsigned[ nr_trans ];
+  stub_dfs = new unsigned[ nr_trans ]; stub_scc = new unsigned[ nr_trans ];
+  stub_min = new unsigned[ nr_trans ]; stub_nr = -1u;
+}
+
+/* Employs a fresh "found"-number. */
+inline void stub_fresh(){
+  ++stub_nr;
+  if( !stub_nr ){
+    for( unsigned tr = 0; tr < nr_trans; ++tr ){ stub_found[ tr ] = 0; }
+    ++stub_nr;
+  }
+}
+
+/* Finds closed sets of not yet tried transitions starting from tr in the
+  current state, and calls fire( t ) for the transitions of each found strong
+  component, until some call returns true. Errors are reported at node ni.
+  Returns whether some call returned true. */
+template< class Fn > bool stub_search( node_idx ni, unsigned tr, Fn &fire ){
+  bool some_fired = false;
+  stub_found[ tr ] = stub_nr; stub_try[ tr ] = ~0u; stub_min[ tr ] = 0;
+  stub_dfs[0] = stub_scc[0] = tr;
+  unsigned dfs_cnt = 1, scc_cnt = 1, watchdog = 0;
+  while( dfs_cnt ){
+
+    /* Extract the transition and its next obligation neighbour. */
+    unsigned t1 = stub_dfs[ dfs_cnt-1 ], sm1 = stub_min[ t1 ];
+    stb_tr = &stub_try[ t1 ]; stb_called = false;
+    #ifdef profile
+    bool counted = prof_counted(), timed = counted && prof_timed();
+    unsigned long long p0 = timed ? prof_now() : 0;
+    #endif
+    model::next_stubborn( t1 );
+    #ifdef profile
+    if( timed ){ prof[ t1 ].stub += prof_now() - p0; }
+    if( counted ){ ++prof[ t1 ].stubs; }
+    #endif
+    if( err_msg ){
+      report_error( ni, "Stubborn set error" ); return some_fired;
+    }
+    unsigned t2 = stub_try[ t1 ];
+
+    /* If no more neighbours, then backtrack. */
+    if( t2 == ~0u ){
+      watchdog = 0; --dfs_cnt;
+
+      /* If strong component is ready, mark and try its transitions. */
+      if( stub_scc[ sm1 ] == t1 ){
+        for( unsigned ii = sm1; ii < scc_cnt; ++ii ){
+          stub_min[ stub_scc[ ii ] ] = ~0u;
+          some_fired |= fire( stub_scc[ ii ] );
+          if( err_msg ){ return some_fired; }
+        }
+        if( some_fired ){ break; }
+        scc_cnt = sm1;
+      }
+
+      /* Otherwise backward-propagate the minimum index, if possible. */
+      else if( dfs_cnt ){
+        t2 = stub_dfs[ dfs_cnt-1 ];
+        if( stub_min[ t2 ] > sm1 ){ stub_min[ t2 ] = sm1; }
+      }
+
+    }
+
+    /* If the neighbour has not been seen, enter it. */
+    else if( stub_found[ t2 ] < stub_nr ){
+      watchdog = 0; stub_found[ t2 ] = stub_nr; stub_try[ t2 ] = ~0u;
+      stub_min[ t2 ] = scc_cnt;
+      stub_dfs[ dfs_cnt++ ] = stub_scc[ scc_cnt++ ] = t2;
+    }
+
+    /* Otherwise just backward-propagate the minimum index. */
+    else{
+      if( ++watchdog > nr_trans ){
+        err_msg = "Same element twice in stb list";
+        report_error( ni, "Stubborn set error" ); return some_fired;
+      }
+      if( sm1 > stub_min[ t2 ] ){ stub_min[ t1 ] = stub_min[ t2 ]; }
+    }
+
+  }
+  return some_fired;
+}
+
+/* Tries the transitions that stub_search gives in build_state_space. */
+struct bss_fire{
+  node_idx n1;
+  bool operator()( unsigned tr ){ return try_transition( n1, tr ); }
+};
+#endif
+
+
+/* Constructs the state space, detecting safety and deadlock errors. */
+void build_state_space(){
+  #ifndef no_show_cnt
+  const char *progress_msg = " states constructed\n\033[F";
+  #ifndef no_progr_chk
+  if( bss_second ){ progress_msg = " states backwards-processed\n\033[F"; }
+  #endif
+  #endif
+
+  /* Variables for finding stubborn sets */
+  #ifdef profile
+  if( prof.empty() ){ prof.resize( nr_trans, prof_tr() ); }
+  #endif
+  #ifdef stubborn
+  stub_alloc();
+  #endif
+
+  /* Investigate states in breadth-first order until the queue is empty. */
+  #ifdef directed
+  #ifndef no_show_cnt
+  node_idx q_cnt = 0;   // number of investigated states
+  #endif
+  for(
+    node_idx q_first = bss_first; q_first < nodes.size();
+    q_first = bss_next( q_first )
+  ){
+  #else
+  for( node_idx q_first = bss_first; q_first < nodes.size(); ++q_first ){
+  #endif
+    edge_idx old_edges = nr_edges;  // for detecting terminal states
+    #ifdef telemetry
+    tel_publish( q_first );
+    #endif
+    #ifdef warm_up
+    sanity_choose( q_first );
+    #endif
+
+    /* When saving or under a memory budget, stop between nodes, so that
+      construction can continue or the results so far can be reported. */
+    #ifdef stop_between
+    if(
+      nodes.size() + nr_trans > stop_count + 1 && !shrink_states( q_first )
+    ){
+      bss_first = q_first; bss_stopped = true;
+      err_msg = "Maximum number of states exceeded"; return;
+    }
+    #endif
+    #ifdef mem_budget
+    if( !budget_check() && !shrink_states( q_first ) ){
+      bss_first = q_first; bss_stopped = true;
+      err_msg = "Memory budget exhausted"; return;
+    }
+    #endif
+
+    /* Occasionally show the number of processed states. */
+    #ifndef no_show_cnt
+    #ifdef directed
+    node_idx q_nr = ++q_cnt;
+    #else
+    node_idx q_nr = q_first;
+    #endif
+    if( q_nr % show_count == 0 ){
+      std::cout << q_nr << progress_msg; std::cout.flush();
+    }
+    #endif
+
+    /* Employ an "enabled was found" bit and a fresh "found"-number. */
+    #ifdef stubborn
+    bool some_fired = false;
+    bss_fire fire = { q_first };
+    stub_fresh();
+    #endif
+
+    /* Try all transitions as such or as starting points of a stubborn set. */
+    fire_init( q_first );
+    #ifdef try_forward
+    for( unsigned tr = 0; tr < nr_trans; ++tr ){
+    #else
+    for( unsigned tr = nr_trans; tr--; ){
+    #endif
+
+      #ifndef stubborn
+      try_transition( q_first, tr );
+      if( err_msg ){ return; }
+
+      #else
 
       /* Reject already tried transitions. */
       if( stub_found[ tr ] == stub_nr ){ continue; }
 
-      /* Find a closed set of transitions that have not yet been tried. */
-      stub_found[ tr ] = stub_nr; stub_try[ tr ] = ~0u; stub_min[ tr ] = 0;
-      stub_dfs[0] = stub_scc[0] = tr; dfs_cnt = scc_cnt = 1;
-      unsigned watchdog = 0;
-      while( dfs_cnt ){
+      /* Find a closed set of transitions that have not yet been tried, and
+        try its transitions. */
+      some_fired = stub_search( q_first, tr, fire );
+      if( err_msg ){ return; }
+      if( some_fired ){ break; }
+      #endif
+
+    }
+
+    /* Check the state against deadlock errors. */
+    #ifndef no_progr_chk
+    if( !bss_second ){
+    #endif
+      if( old_edges == nr_edges ){
+        #ifdef chk_deadlock
+        use_state( q_first ); err_msg = model::check_deadlock();
+        if( err_msg ){ report_error( q_first, "Illegal deadlock" ); return; }
+        #endif
+        #ifdef chk_props
+        use_state( q_first ); check_props( q_first, prop_dl );
+        #endif
+      }
+    #ifndef no_progr_chk
+    }
+    #endif
+
+  }
+
+  /* Wipe out displayed running state count and clean up memory. */
+  std::cout << clean_eol;
+  #ifdef warm_up
+  sanity_on = true;
+  #endif
+  #ifdef stubborn
+  stub_free();
+  #endif
+
+}
+
+
+/* Import of the state space */
+/* The state space is read from a file written with lts_file. The first pass
+  creates the nodes and counts the edges, and the second pass, made by
+  construct_input_edges, puts the edges in iedges. The states are also put
+  in the hash table, so that counterexamples can be printed. */
+#ifdef lts_input
+
+/* A file that is read via a buffer */
+class in_file{
+  int fd;
+  std::vector< char > buf;
+  size_t pos, len;
+  bool fill(){
+    ssize_t nn = read( fd, &buf[0], buf.size() );
+    pos = 0; len = nn > 0 ? nn : 0; return len;
+  }
+public:
+  in_file(): fd( -1 ), buf( 1u << 16 ), pos( 0 ), len( 0 ){}
+  bool open_file( const char *name ){
+    fd = open( name, O_RDONLY ); pos = len = 0; return fd >= 0;
+  }
+  void rewind(){ lseek( fd, 0, SEEK_SET ); pos = len = 0; }
+  inline bool at_end(){ return pos == len && !fill(); }
+  inline unsigned char get_byte(){
+    if( at_end() ){ err_msg = "lts_input ends unexpectedly"; return 0; }
+    return buf[ pos++ ];
+  }
+  inline unsigned long long get_num(){
+    unsigned long long val = 0;
+    for( unsigned sh = 0; sh < 64; sh += 7 ){
+      unsigned char bb = get_byte();
+      val |= (unsigned long long)( bb & 127 ) << sh;
+      if( !( bb & 128 ) ){ return val; }
+    }
+    err_msg = "lts_input is corrupted"; return 0;
+  }
+  void get( void *pp, size_t nn ){
+    char *cp = (char *)pp;
+    for( size_t ii = 0; ii < nn; ++ii ){ cp[ ii ] = get_byte(); }
+  }
+  void finish(){ if( fd >= 0 ){ close( fd ); fd = -1; } }
+  ~in_file(){ finish(); }
+};
+in_file lts_in_file;
+
+void lts_read( bool second ){
+  unsigned nr_words = state_var::nr_words;
+  if( second ){ lts_in_file.rewind(); }
+  else if( !lts_in_file.open_file( lts_input ) ){
+    err_msg = "Cannot open lts_input"; return;
+  }
+
+  /* Check the header and the initial state. */
+  char magic[8]; unsigned hd[4];
+  lts_in_file.get( magic, 8 ); lts_in_file.get( hd, sizeof( hd ) );
+  std::vector< unsigned > init( nr_words );
+  lts_in_file.get( &init[0], sizeof( unsigned ) * nr_words );
+  if( err_msg ){ return; }
+  if( std::memcmp( magic, "ASSETlts", 8 ) || hd[0] != lts_version ){
+    err_msg = "lts_input is not an ASSET state space file"; return;
+  }
+  if(
+    hd[1] != state_var::layout() || hd[2] != nr_words || hd[3] != nr_trans ||
+    std::memcmp(
+      &init[0], &state_var::st_data[ nr_words ], sizeof( unsigned ) * nr_words
+    )
+  ){ err_msg = "lts_input was made from a different model"; return; }
+
+  /* Read the edges and the new states. */
+  node_idx src = 0, nr_states = 1;
+  while( !lts_in_file.at_end() ){
+    src += lts_in_file.get_num();
+    unsigned long long tr = lts_in_file.get_num();
+    node_idx tgt = lts_in_file.get_num();
+    if( err_msg ){ return; }
+    if(
+      !src || src > nr_states || tr >= nr_trans || !tgt ||
+      tgt > nr_states + 1
+    ){ err_msg = "lts_input is corrupted"; return; }
+    if( tgt > nr_states ){
+      ++nr_states;
+      if( second ){
+        lts_in_file.get( &init[0], sizeof( unsigned ) * nr_words );
+      }
+      else{
+        lts_in_file.get(
+          &state_var::st_data[ nodes.size() * nr_words ],
+          sizeof( unsigned ) * nr_words
+        );
+        if( hash_insert() != tgt || !hash_was_new ){
+          if( !err_msg ){ err_msg = "lts_input is corrupted"; }
+          return;
+        }
+        nodes.prev[ tgt ] = src;
+      }
+    }
+    #ifndef no_progr_chk
+    if( second ){
+      edge_idx ei = nodes.ie_end[ tgt ]++;
+      iedges[ ei ] = src;
+      #ifdef tr_labels
+      ie_tr[ ei ] = tr;
+      #endif
+      continue;
+    }
+    ++nodes.e_cnt[ tgt ];
+    #endif
+    ++nr_edges;
+  }
+
+  /* The file is read again for the incoming edges, if they are needed. */
+  #ifdef no_progr_chk
+  lts_in_file.finish();
+  #else
+  if( second ){ lts_in_file.finish(); }
+  #endif
+
+}
+#endif
+
+
+/* Divergence-sensitive branching bisimulation */
+/* The states of the graph are 1, ..., nn-1. The incoming edges of state ni
+  are ie_end[ ni-1 ], ..., ie_end[ ni ] - 1, where ie_end[ 0 ] = 0. The
+  source of edge ei is iedges[ ei ], and its transition is etr[ ei ], or tau
+  if etr == 0. Only equally labelled states may be bisimilar. An edge is
+  inert, if its transition is tau and its end states are in the same block.
+  First the strongly connected components of tau edges between equally
+  labelled states are found; those with a cycle are divergent. Then the
+  blocks of components are refined until stable by their signatures, that
+  is, the pairs (transition, block) that are reachable via inert edges and
+  one non-inert edge, and a mark for divergence, which is ~0u. */
+#ifdef bisim
+typedef std::pair< unsigned, node_idx > sig_pair;
+const unsigned sig_div = ~0u;
+
+/* Orders components by their blocks and signatures. */
+struct sig_less{
+  const std::vector< node_idx > &block;
+  const std::vector< std::vector< sig_pair > > &sig;
+  sig_less(
+    const std::vector< node_idx > &block,
+    const std::vector< std::vector< sig_pair > > &sig
+  ): block( block ), sig( sig ){}
+  bool operator()( node_idx c1, node_idx c2 ) const {
+    if( block[ c1 ] != block[ c2 ] ){ return block[ c1 ] < block[ c2 ]; }
+    return sig[ c1 ] < sig[ c2 ];
+  }
+};
+
+/* Returns the number of blocks. Puts the block of each state in sblock and
+  tells in bdiv which blocks are divergent. */
+node_idx bisim_blocks(
+  node_idx nn, const edge_idx *ie_end, const node_idx *iedges,
+  const unsigned *etr, unsigned tau,
+  const std::vector< unsigned long long > &label,
+  std::vector< node_idx > &sblock, std::vector< char > &bdiv
+){
+
+  /* Find the strongly connected components with Tarjan's algorithm,
+    following the edges backwards. A component gets its number after its
+    predecessors. */
+  const node_idx none = ~node_idx( 0 );
+  std::vector< node_idx > scc( nn, none ), num( nn ), low( nn ), stk;
+  std::vector< node_idx > scc_seq, scc_end;   // the states of the components
+  std::vector< char > self( nn ), div;
+  std::vector< std::pair< node_idx, edge_idx > > dfs;
+  node_idx cnt = 0, nr_scc = 0;
+  for( node_idx rt = 1; rt < nn; ++rt ){
+    if( num[ rt ] ){ continue; }
+    num[ rt ] = low[ rt ] = ++cnt; stk.push_back( rt );
+    dfs.push_back( std::make_pair( rt, ie_end[ rt-1 ] ) );
+    while( !dfs.empty() ){
+      node_idx v1 = dfs.back().first;
+      if( dfs.back().second < ie_end[ v1 ] ){
+        edge_idx ei = dfs.back().second++;
+        node_idx v2 = iedges[ ei ];
+        if( ( etr && etr[ ei ] != tau ) || label[ v2 ] != label[ v1 ] ){
+          continue;
+        }
+        if( v2 == v1 ){ self[ v1 ] = 1; }
+        else if( !num[ v2 ] ){
+          num[ v2 ] = low[ v2 ] = ++cnt; stk.push_back( v2 );
+          dfs.push_back( std::make_pair( v2, ie_end[ v2-1 ] ) );
+        }else if( scc[ v2 ] == none && num[ v2 ] < low[ v1 ] ){
+          low[ v1 ] = num[ v2 ];
+        }
+        continue;
+      }
+      dfs.pop_back();
+      if( !dfs.empty() && low[ v1 ] < low[ dfs.back().first ] ){
+        low[ dfs.back().first ] = low[ v1 ];
+      }
+      if( low[ v1 ] != num[ v1 ] ){ continue; }
+      node_idx v2, beg = scc_seq.size();
+      bool dv = false;
+      do{
+        v2 = stk.back(); stk.pop_back();
+        scc[ v2 ] = nr_scc; scc_seq.push_back( v2 ); dv = dv || self[ v2 ];
+      }while( v2 != v1 );
+      div.push_back( dv || scc_seq.size() - beg > 1 );
+      scc_end.push_back( scc_seq.size() ); ++nr_scc;
+    }
+  }
+  free_column( num ); free_column( low ); free_column( self );
+
+  /* The first signatures are the labels. */
+  std::vector< node_idx > block( nr_scc ), ord( nr_scc );
+  std::vector< std::vector< sig_pair > > sig( nr_scc );
+  for( node_idx cc = 0; cc < nr_scc; ++cc ){
+    unsigned long long lb = label[ scc_seq[ scc_end[ cc ] - 1 ] ];
+    sig[ cc ].push_back( sig_pair( unsigned( lb ), node_idx( lb >> 32 ) ) );
+    ord[ cc ] = cc;
+  }
+
+  /* Refine the blocks until their number does not change. */
+  node_idx nb = 0;
+  for(;;){
+
+    /* Give the components new blocks according to their signatures. */
+    std::sort( ord.begin(), ord.end(), sig_less( block, sig ) );
+    std::vector< node_idx > nblock( nr_scc );
+    node_idx nb2 = 0;
+    for( node_idx ii = 0; ii < nr_scc; ++ii ){
+      if( ii && sig_less( block, sig )( ord[ ii-1 ], ord[ ii ] ) ){ ++nb2; }
+      nblock[ ord[ ii ] ] = nb2;
+    }
+    block.swap( nblock ); ++nb2;
+    if( nb2 == nb ){ break; }
+    nb = nb2;
+
+    /* Collect the non-inert edges of the components. */
+    for( node_idx cc = 0; cc < nr_scc; ++cc ){
+      sig[ cc ].clear();
+      if( div[ cc ] ){ sig[ cc ].push_back( sig_pair( sig_div, 0 ) ); }
+    }
+    for( node_idx ni = 1; ni < nn; ++ni ){
+      node_idx c2 = scc[ ni ];
+      for( edge_idx ei = ie_end[ ni-1 ]; ei < ie_end[ ni ]; ++ei ){
+        node_idx c1 = scc[ iedges[ ei ] ];
+        unsigned tr = etr ? etr[ ei ] : tau;
+        if( tr == tau && block[ c1 ] == block[ c2 ] ){ continue; }
+        sig[ c1 ].push_back( sig_pair( tr, block[ c2 ] ) );
+      }
+    }
+
+    /* Add the signatures of inert successors, successors first. */
+    for( node_idx c2 = nr_scc; c2--; ){
+      std::sort( sig[ c2 ].begin(), sig[ c2 ].end() );
+      sig[ c2 ].erase(
+        std::unique( sig[ c2 ].begin(), sig[ c2 ].end() ), sig[ c2 ].end()
+      );
+      for(
+        node_idx ii = c2 ? scc_end[ c2-1 ] : 0; ii < scc_end[ c2 ]; ++ii
+      ){
+        node_idx ni = scc_seq[ ii ];
+        for( edge_idx ei = ie_end[ ni-1 ]; ei < ie_end[ ni ]; ++ei ){
+          node_idx c1 = scc[ iedges[ ei ] ];
+          if(
+            c1 != c2 && block[ c1 ] == block[ c2 ] &&
+            ( !etr || etr[ ei ] == tau )
+          ){
+            sig[ c1 ].insert(
+              sig[ c1 ].end(), sig[ c2 ].begin(), sig[ c2 ].end()
+            );
+          }
+        }
+      }
+    }
+
+  }
+
+  /* Give the blocks to the states. */
+  sblock.assign( nn, 0 ); bdiv.assign( nb, 0 );
+  for( node_idx ni = 1; ni < nn; ++ni ){ sblock[ ni ] = block[ scc[ ni ] ]; }
+  for( node_idx cc = 0; cc < nr_scc; ++cc ){
+    if( !sig[ cc ].empty() && sig[ cc ].back().first == sig_div ){
+      bdiv[ block[ cc ] ] = 1;
+    }
+  }
+  return nb;
+
+}
+#endif
+
+
+/* Define dummy or real non-progress detection functions, as needed. */
+#ifdef no_progr_chk
+void construct_input_edges(){}
+void verify_progress( unsigned, bool (*)() = 0, prop_type * = 0 ){}
+void fused_progress(){}
+void fused_report( unsigned ){}
+#else
+
+/* Constructs a data structure for incoming edges of each node. */
+void construct_input_edges(){
+  #ifdef mem_budget
+  if( budget_no_progr ){ return; }
+  #endif
+
+  #ifdef edge_file
+  /* Re-generate the edges, writing them to the files. */
+  ie_open( nodes.size() );
+  if( err_msg ){ return; }
+  bss_second = true; bss_first = 1; build_state_space();
+  for( unsigned bi = 0; bi < ie_files.size(); ++bi ){
+    ie_flush( ie_files[ bi ] ); free_column( ie_files[ bi ].buf );
+  }
+  return;
+  #endif
+
+  nodes.ie_end.resize( nodes.size() );
+  #ifdef packed_edges
+  /* Find the lengths of the lists, unless construction found them, and make
+    them start indices. */
+  #ifndef packed_sized
+  nodes.ie_last.assign( nodes.size(), 0 );
+  nodes.e_cnt.assign( nodes.size(), 0 );
+  ie_sizing = true; bss_second = true; bss_first = 1; build_state_space();
+  ie_sizing = false;
+  if( err_msg ){ return; }
+  #endif
+  unsigned long long sum = 0;
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+    nodes.ie_end[ ni ] = sum; sum += nodes.e_cnt[ ni ];
+  }
+  if( edge_idx( sum ) != sum ){
+    err_msg = "Too many bytes of packed edges (try wide_idx)"; return;
+  }
+  iedges = new unsigned char[ sum ? sum : 1 ];
+  nodes.ie_last.assign( nodes.size(), 0 );
+  #else
+  iedges = new node_idx[ nr_edges ];
+  #ifdef tr_labels
+  ie_tr = new unsigned[ nr_edges ];
+  #endif
+
+  /* Count the indices of incoming edges, using already computed counts. */
+  nodes.ie_end[ 0 ] = nodes.ie_end[ 1 ] = 0;
+  for( node_idx ni = 2; ni < nodes.size(); ++ni ){
+    nodes.ie_end[ ni ] = nodes.ie_end[ ni-1 ] + nodes.e_cnt[ ni-1 ];
+  }
+  #endif
+
+  /* Re-generate the edges, putting them in iedges. */
+  #ifdef lts_input
+  lts_read( true ); return;
+  #else
+  bss_second = true; bss_first = 1; build_state_space();
+  #ifdef packed_edges
+  free_column( nodes.ie_last );
+  #endif
+  return;
+  #endif
+
+}
+
+/* Minimization of the state space */
+/* Each state gets a label that tells for which progress checks it is a
+  progress state. Bit 0 is for terminal states, bit 1 for may progress, bit 2
+  for must progress, and bit 3 + i for registered property i. Invisible
+  transitions are represented by nr_trans. The quotient has an edge for each
+  non-inert edge and a self-loop for each divergent block. */
+#ifdef minimize
+#ifdef dl_not_may
+const bool min_dl_may = false;
+#else
+const bool min_dl_may = true;
+#endif
+#ifdef dl_not_must
+const bool min_dl_must = false;
+#else
+const bool min_dl_must = true;
+#endif
+
+node_idx nr_blocks = 0;             // 0 if the state space was not minimized
+std::vector< unsigned long long > q_label;  // labels of the blocks
+std::vector< edge_idx > q_ie_end;   // incoming edges of block b are from
+std::vector< node_idx > q_iedges;   //   q_ie_end[ b ] to q_ie_end[ b+1 ] - 1
+
+/* Returns the bit of the label that corresponds to a progress check. */
+unsigned min_bit( unsigned round, prop_type *pr ){
+  if( pr ){ return 3 + ( pr - &props[0] ); }
+  return round == 2 ? 0 : round + 1;
+}
+
+void minimize_state_space(){
+  #ifdef tr_labels
+  if( !ie_tr ){ return; }   // the edges came from a file without transitions
+  #endif
+  if( 3 + props.size() > 64 ){ return; }
+  node_idx nn = nodes.size();
+
+  /* Compute the labels of the states. */
+  std::vector< unsigned long long > label( nn );
+  std::vector< char > has_out( nn );
+  for( edge_idx ei = 0; ei < nr_edges; ++ei ){ has_out[ iedges[ ei ] ] = 1; }
+  for( node_idx ni = 1; ni < nn; ++ni ){
+    bool term = !has_out[ ni ];
+    unsigned long long lb = term;
+    use_state( ni );
+    #ifdef chk_may_progress
+    if( ( min_dl_may && term ) || model::is_may_progress() ){ lb |= 2; }
+    #endif
+    #ifdef chk_must_progress
+    if( ( min_dl_must && term ) || model::is_must_progress() ){ lb |= 4; }
+    #endif
+    for( unsigned pi = 0; pi < props.size(); ++pi ){
+      const prop_type &pr = props[ pi ];
+      if( pr.kind != prop_may_pr && pr.kind != prop_must_pr ){ continue; }
+      bool dl = pr.kind == prop_may_pr ? min_dl_may : min_dl_must;
+      if( ( dl && term ) || pr.is_progress() ){ lb |= 1ull << ( 3 + pi ); }
+    }
+    if( err_msg ){ err_msg = 0; return; }   // left to the progress checks
+    label[ ni ] = lb;
+  }
+  free_column( has_out );
+
+  /* Compute the blocks. */
+  std::vector< unsigned > etr;
+  #ifdef tr_labels
+  etr.resize( nr_edges );
+  for( edge_idx ei = 0; ei < nr_edges; ++ei ){
+    etr[ ei ] = model::is_visible( ie_tr[ ei ] ) ? ie_tr[ ei ] : nr_trans;
+  }
+  #endif
+  std::vector< node_idx > sblock;
+  std::vector< char > bdiv;
+  node_idx nb = bisim_blocks(
+    nn, &nodes.ie_end[0], iedges, etr.empty() ? 0 : &etr[0], nr_trans,
+    label, sblock, bdiv
+  );
+
+  /* Construct the quotient, with its edges sorted by target block. */
+  nr_blocks = nb;
+  q_label.assign( nb, 0 ); q_ie_end.assign( nb + 1, 0 );
+  for( node_idx ni = 1; ni < nn; ++ni ){
+    q_label[ sblock[ ni ] ] = label[ ni ];
+  }
+  for( unsigned pass = 0; pass < 2; ++pass ){
+    if( pass ){
+      for( node_idx bb = 1; bb < nb; ++bb ){
+        q_ie_end[ bb ] += q_ie_end[ bb-1 ];
+      }
+      q_ie_end[ nb ] = q_ie_end[ nb-1 ]; q_iedges.resize( q_ie_end[ nb ] );
+    }
+    for( node_idx ni = 1; ni < nn; ++ni ){
+      node_idx b2 = sblock[ ni ];
+      for(
+        edge_idx ei = nodes.ie_end[ ni-1 ]; ei < nodes.ie_end[ ni ]; ++ei
+      ){
+        node_idx b1 = sblock[ iedges[ ei ] ];
+        if( b1 == b2 && ( etr.empty() || etr[ ei ] == nr_trans ) ){
+          continue;
+        }
+        if( pass ){ q_iedges[ --q_ie_end[ b2 ] ] = b1; }
+        else{ ++q_ie_end[ b2 ]; }
+      }
+    }
+    for( node_idx bb = 0; bb < nb; ++bb ){
+      if( !bdiv[ bb ] ){ continue; }
+      if( pass ){ q_iedges[ --q_ie_end[ bb ] ] = bb; }
+      else{ ++q_ie_end[ bb ]; }
+    }
+  }
+
+}
+
+/* Makes the progress check of the given bit of the labels on the quotient,
+  like verify_progress. Returns true if the check succeeds, because then it
+  succeeds also on the full state space. */
+bool min_progress( unsigned bit, bool must ){
+  if( !nr_blocks ){ return false; }
+  std::vector< edge_idx > npn( nr_blocks, must ? 0 : 1 );
+  std::vector< node_idx > p_list;
+  if( must ){
+    for( edge_idx ei = 0; ei < q_iedges.size(); ++ei ){
+      ++npn[ q_iedges[ ei ] ];
+    }
+  }
+  for( node_idx bb = 0; bb < nr_blocks; ++bb ){
+    if( q_label[ bb ] >> bit & 1 ){ npn[ bb ] = 0; p_list.push_back( bb ); }
+    else if( !npn[ bb ] ){ npn[ bb ] = 1; }
+  }
+  while( !p_list.empty() ){
+    node_idx b2 = p_list.back(); p_list.pop_back();
+    for( edge_idx ei = q_ie_end[ b2 ]; ei < q_ie_end[ b2+1 ]; ++ei ){
+      node_idx b1 = q_iedges[ ei ];
+      if( npn[ b1 ] && !--npn[ b1 ] ){ p_list.push_back( b1 ); }
+    }
+  }
+  for( node_idx bb = 0; bb < nr_blocks; ++bb ){
+    if( npn[ bb ] ){ return false; }
+  }
+  return true;
+}
+#endif
+
+
+/* Finds the first node whose e_cnt is not 0, if there is one, and reports a
+  non-progress error of the round or of pr in it. */
+void progress_report( unsigned round, prop_type *pr ){
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+    if( nodes.e_cnt[ ni ] ){
+
+      /* Print history up to entering the state that violates progress. */
+      std::cout << clean_eol; print_history( nodes.prev[ ni ] );
+      std::cout << "==========\n";
+
+      /* Print a typical sequence of events starting at the error node. */
+      print_typical( ni, true );
+
+      /* Record the violation of a registered property. */
+      if( pr ){ pr->node = ni; report_prop( *pr ); return; }
+
+      /* Report the error. */
+      err_msg = "";
+      if( round == 0 ){
+        report_error( 0, "May-type non-progress error" ); return;
+      }else if( round == 1 ){
+        report_error( 0, "Must-type non-progress error" ); return;
+      }else if( round == 2 ){
+        report_error(
+          0, "State was reached from which termination is unreachable"
+        );
+        return;
+      }
+
+    }
+  }
+
+}
+
+
+#ifdef edge_file
+/* Helpers of the progress checks for ie_all and ie_sweep */
+void ie_count( node_idx n1, node_idx ){ ++nodes.e_cnt[ n1 ]; }
+void ie_one( node_idx n1, node_idx ){ nodes.e_cnt[ n1 ] = 1; }
+unsigned char vp_take( node_idx ){ return 1; }
+void vp_edge( node_idx ni, unsigned char ){
+  if( nodes.e_cnt[ ni ] && !--nodes.e_cnt[ ni ] ){ ie_queue( ni ); }
+}
+#endif
+
+/* Finds non-progress errors. In rounds 0 and 1, is_progress tells whether a
+  state is a may or must progress state, respectively. If pr is given, a
+  violation is recorded in it instead of stopping the analysis. */
+void verify_progress(
+  unsigned round, bool (*is_progress)() = 0, prop_type *pr = 0
+){
+  #ifdef mem_budget
+  if( budget_no_progr ){ return; }
+  #endif
+  #ifdef minimize
+  if( min_progress( min_bit( round, pr ), round == 1 ) ){ return; }
+  #endif
+  #ifndef edge_file
+  nodes.p_next.resize( nodes.size() );
+  #endif
+
+  /* Compute initial values of non-progress numbers depending on round. */
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){ nodes.e_cnt[ ni ] = 0; }
+  #ifdef edge_file
+  if( round == 1 ){ ie_all( ie_count ); }else{ ie_all( ie_one ); }
+  if( err_msg ){ report_error( 0, "Progress check error" ); return; }
+  #else
+  for( node_idx n2 = 1; n2 < nodes.size(); ++n2 ){
+    ie_iter it( n2 ); node_idx n1;
+    if( round == 1 ){   // npn = the number of the output edges of the node.
+      while( it.next( n1 ) ){ ++nodes.e_cnt[ n1 ]; }
+    }else{              // npn = 0 if node has no output edges, otherwise 1.
+      while( it.next( n1 ) ){ nodes.e_cnt[ n1 ] = 1; }
+    }
+  }
+  #endif
+
+  /* Make npn:s 0 for progress states and 1 for non-progress deadlocks. */
+  if( round == 0 ){
+    for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+      #ifdef dl_not_may
+      if( !nodes.e_cnt[ ni ] ){ nodes.e_cnt[ ni ] = 1; }
+      #endif
+      if( nodes.e_cnt[ ni ] ){
+        use_state( ni );
+        if( !is_progress || is_progress() ){ nodes.e_cnt[ ni ] = 0; }
+        if( err_msg ){
+          report_error( ni, "may_progress modelling error" ); return;
+        }
+      }
+    }
+  }else if( round == 1 ){
+    for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+      #ifdef dl_not_must
+      if( !nodes.e_cnt[ ni ] ){ nodes.e_cnt[ ni ] = 1; }
+      #endif
+      if( nodes.e_cnt[ ni ] ){
+        use_state( ni );
+        if( !is_progress || is_progress() ){ nodes.e_cnt[ ni ] = 0; }
+        if( err_msg ){
+          report_error( ni, "must_progress modelling error" ); return;
+        }
+      }
+    }
+  }
+
+  /* Backwards-propagate the information that a node with npn = 0 is reachable
+    via all / at least one output edge. */
+  #ifdef edge_file
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+    if( !nodes.e_cnt[ ni ] ){ ie_queue( ni ); }
+  }
+  ie_sweep( vp_take, vp_edge );
+  if( err_msg ){ report_error( 0, "Progress check error" ); return; }
+  #else
+  node_idx p_list = 0;
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+    if( !nodes.e_cnt[ ni ] ){ nodes.p_next[ ni ] = p_list; p_list = ni; }
+  }
+  for( ; p_list; p_list = nodes.p_next[ p_list ] ){
+    ie_iter it( p_list ); node_idx ni;
+    while( it.next( ni ) ){
+      if( nodes.e_cnt[ ni ] ){
+        --nodes.e_cnt[ ni ];
+        if( !nodes.e_cnt[ ni ] ){
+          nodes.p_next[ ni ] = nodes.p_next[ p_list ];
+          nodes.p_next[ p_list ] = ni;
+        }
+      }
+    }
+  }
+  #endif
+
+  progress_report( round, pr );
+}
+
+
+/* Progress checks in one sweep */
+/* The may progress, must progress, and termination (round 2) checks are made
+  together. Bits 0, 1, and 2 of p_flags[ ni ] tell that node ni has not yet
+  been found to reach progress in the corresponding check, bits 4, 5, and 6
+  that this has been found but not yet propagated to the predecessors, and
+  bit 7 that the node is in the list of nodes to propagate. The number of
+  remaining non-progress output edges of the must check is in e_cnt. A node
+  is taken from the list once for each time some of its bits were found, and
+  all of them are propagated in the same scan of its incoming edges. The
+  errors are reported by fused_report in the same order as before. */
+std::vector< unsigned char > p_flags;
+node_idx p_must_err = 0;          // node of a must_progress modelling error
+const char *p_must_msg = 0;       //   and its message
+
+/* Propagates the bits found for a successor of n1 to n1, and returns true if
+  n1 must be put in the list. */
+inline bool fp_edge( node_idx n1, unsigned char found ){
+  unsigned char fl = p_flags[ n1 ], now = fl & found & 5;
+  if( found & fl & 2 && !--nodes.e_cnt[ n1 ] ){ now |= 2; }
+  if( !now ){ return false; }
+  fl = ( fl & ~now ) | now << 4;
+  p_flags[ n1 ] = fl | 0x80; return !( fl & 0x80 );
+}
+
+#ifdef edge_file
+unsigned char fp_take( node_idx ni ){
+  unsigned char found = p_flags[ ni ] >> 4 & 7;
+  p_flags[ ni ] &= 7; return found;
+}
+void fp_spill( node_idx n1, unsigned char found ){
+  if( fp_edge( n1, found ) ){ ie_queue( n1 ); }
+}
+#endif
+
+void fused_progress(){
+  #ifdef stats_only
+  return;
+  #endif
+  #ifdef mem_budget
+  if( budget_no_progr ){ return; }
+  #endif
+  unsigned char active = 0;       // the checks to make
+  #ifdef chk_may_progress
+  active |= 1;
+  #ifdef minimize
+  if( min_progress( min_bit( 0, 0 ), false ) ){ active &= ~1; }
+  #endif
+  #endif
+  #ifdef chk_must_progress
+  active |= 2;
+  #ifdef minimize
+  if( min_progress( min_bit( 1, 0 ), true ) ){ active &= ~2; }
+  #endif
+  #endif
+  #ifdef stubborn
+  active |= 4;
+  #ifdef minimize
+  if( min_progress( min_bit( 2, 0 ), false ) ){ active &= ~4; }
+  #endif
+  #endif
+  p_flags.assign( nodes.size(), 0 );
+  if( !active ){ return; }
+  #ifndef edge_file
+  nodes.p_next.resize( nodes.size() );
+  #endif
+
+  /* Count the output edges of the nodes. */
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){ nodes.e_cnt[ ni ] = 0; }
+  #ifdef edge_file
+  ie_all( ie_count );
+  if( err_msg ){ report_error( 0, "Progress check error" ); return; }
+  #else
+  for( node_idx n2 = 1; n2 < nodes.size(); ++n2 ){
+    ie_iter it( n2 ); node_idx n1;
+    while( it.next( n1 ) ){ ++nodes.e_cnt[ n1 ]; }
+  }
+  #endif
+
+  /* Find the initial non-progress nodes, and list the others. */
+  #ifndef edge_file
+  node_idx p_list = 0;
+  #endif
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+    bool dl = !nodes.e_cnt[ ni ];
+    unsigned char fl = 0;
+    if( active & 1 ){
+      #ifdef chk_may_progress
+      bool np = !dl;
+      #ifdef dl_not_may
+      np = true;
+      #endif
+      if( np ){
+        use_state( ni );
+        if( !model::is_may_progress() ){ fl |= 1; }
+        if( err_msg ){
+          report_error( ni, "may_progress modelling error" ); return;
+        }
+      }
+      #endif
+    }
+    if( active & 2 ){
+      #ifdef chk_must_progress
+      bool np = !dl;
+      #ifdef dl_not_must
+      np = true;
+      #endif
+      if( np && !p_must_err ){
+        use_state( ni );
+        if( !model::is_must_progress() ){ fl |= 2; }
+        if( err_msg ){ p_must_err = ni; p_must_msg = err_msg; err_msg = 0; }
+      }
+      if( dl && fl & 2 ){ nodes.e_cnt[ ni ] = 1; }
+      #endif
+    }
+    if( active & 4 && !dl ){ fl |= 4; }
+    fl |= ( active & ~fl ) << 4;
+    #ifdef edge_file
+    if( fl & 0x70 ){ fl |= 0x80; ie_queue( ni ); }
+    #else
+    if( fl & 0x70 ){ fl |= 0x80; nodes.p_next[ ni ] = p_list; p_list = ni; }
+    #endif
+    p_flags[ ni ] = fl;
+  }
+
+  /* Backwards-propagate the information that a progress node is reachable
+    via all (must) or at least one (may and termination) output edge. */
+  #ifdef edge_file
+  ie_sweep( fp_take, fp_spill );
+  if( err_msg ){ report_error( 0, "Progress check error" ); }
+  #else
+  while( p_list ){
+    node_idx n2 = p_list; p_list = nodes.p_next[ n2 ];
+    unsigned char found = p_flags[ n2 ] >> 4 & 7;
+    p_flags[ n2 ] &= 7;
+    ie_iter it( n2 ); node_idx n1;
+    while( it.next( n1 ) ){
+      if( fp_edge( n1, found ) ){ nodes.p_next[ n1 ] = p_list; p_list = n1; }
+    }
+  }
+  #endif
+}
+
+/* Reports the error of round 0, 1, or 2 of fused_progress, if there is one. */
+void fused_report( unsigned round ){
+  if( p_flags.empty() ){ return; }
+  if( round == 1 && p_must_err ){
+    err_msg = p_must_msg;
+    report_error( p_must_err, "must_progress modelling error" ); return;
+  }
+  for( node_idx ni = 1; ni < nodes.size(); ++ni ){
+    nodes.e_cnt[ ni ] = p_flags[ ni ] >> round & 1;
+  }
+  progress_report( round, 0 );
+}
+#endif
+
+/* Structural statistics */
+/* With stats_file, the shape of the state space is written as a JSON object
+  after construction: the numbers of states per level (the length of the path
+  via which the state was found, that is, the breadth-first level unless a
+  directed search is used), the distributions of the numbers of outgoing and
+  incoming edges of the states, the number of terminal states, the numbers
+  and sizes of the strongly connected components and how many of them have
+  no outgoing edges, and the lengths of the lists of the hash table. The
+  distributions are lists of [ value, number of cases ] pairs. The strongly
+  connected components are found as in bisim_blocks, but with ie_iter. */
+#ifdef stats_file
+
+/* Writes a distribution as its non-zero entries. */
+void stats_hist(
+  std::FILE *out, const char *name,
+  const std::vector< unsigned long long > &hist, bool last = false
+){
+  std::fprintf( out, "  \"%s\": [", name );
+  const char *sep = "";
+  for( size_t ii = 0; ii < hist.size(); ++ii ){
+    if( !hist[ ii ] ){ continue; }
+    std::fprintf( out, "%s[%llu,%llu]", sep, (unsigned long long)ii,
+      hist[ ii ] );
+    sep = ",";
+  }
+  std::fprintf( out, "]%s\n", last ? "" : "," );
+}
+
+/* Adds one case of value vv to hist. */
+inline void stats_add( std::vector< unsigned long long > &hist, size_t vv ){
+  if( vv >= hist.size() ){ hist.resize( vv + 1 ); }
+  ++hist[ vv ];
+}
+
+void write_stats(){
+  std::FILE *out = stdout;
+  if( std::strcmp( stats_file, "-" ) ){ out = std::fopen( stats_file, "w" ); }
+  if( !out ){ err_msg = "Could not open stats_file"; return; }
+  node_idx nn = nodes.size();
+
+  /* Levels, and the numbers of edges of the states */
+  std::vector< unsigned long long > levels, out_deg, in_deg;
+  std::vector< node_idx > cnt( nn );
+  {
+    std::vector< unsigned > lvl( nn );
+    for( node_idx ni = 1; ni < nn; ++ni ){
+      if( nodes.prev[ ni ] ){ lvl[ ni ] = lvl[ nodes.prev[ ni ] ] + 1; }
+      stats_add( levels, lvl[ ni ] );
+    }
+  }
+  for( node_idx n2 = 1; n2 < nn; ++n2 ){
+    ie_iter it( n2 ); node_idx n1; edge_idx ec = 0;
+    while( it.next( n1 ) ){ ++cnt[ n1 ]; ++ec; }
+    stats_add( in_deg, ec );
+  }
+  node_idx terminal = 0;
+  for( node_idx ni = 1; ni < nn; ++ni ){
+    stats_add( out_deg, cnt[ ni ] );
+    if( !cnt[ ni ] ){ ++terminal; }
+  }
+
+  /* Strongly connected components, following the edges backwards */
+  const node_idx none = ~node_idx( 0 );
+  std::vector< node_idx > &num = cnt;   // the out-degrees are not needed
+  std::vector< node_idx > low( nn ), scc( nn, none ), stk;
+  std::vector< std::pair< node_idx, ie_iter > > dfs;
+  std::vector< unsigned long long > scc_size;
+  node_idx nr = 0, nr_scc = 0, biggest = 0;
+  num.assign( nn, 0 );
+  for( node_idx rt = 1; rt < nn; ++rt ){
+    if( num[ rt ] ){ continue; }
+    num[ rt ] = low[ rt ] = ++nr; stk.push_back( rt );
+    dfs.push_back( std::make_pair( rt, ie_iter( rt ) ) );
+    while( !dfs.empty() ){
+      node_idx v1 = dfs.back().first, v2;
+      if( dfs.back().second.next( v2 ) ){
+        if( !num[ v2 ] ){
+          num[ v2 ] = low[ v2 ] = ++nr; stk.push_back( v2 );
+          dfs.push_back( std::make_pair( v2, ie_iter( v2 ) ) );
+        }else if( scc[ v2 ] == none && num[ v2 ] < low[ v1 ] ){
+          low[ v1 ] = num[ v2 ];
+        }
+        continue;
+      }
+      dfs.pop_back();
+      if( !dfs.empty() && low[ v1 ] < low[ dfs.back().first ] ){
+        low[ dfs.back().first ] = low[ v1 ];
+      }
+      if( low[ v1 ] != num[ v1 ] ){ continue; }
+      node_idx sz = 0;
+      do{
+        v2 = stk.back(); stk.pop_back(); scc[ v2 ] = nr_scc; ++sz;
+      }while( v2 != v1 );
+      stats_add( scc_size, sz ); if( sz > biggest ){ biggest = sz; }
+      ++nr_scc;
+    }
+  }
+  free_column( num ); free_column( low );
+
+  /* A component is terminal, if no edge leaves it. */
+  std::vector< char > leaves( nr_scc );
+  for( node_idx n2 = 1; n2 < nn; ++n2 ){
+    ie_iter it( n2 ); node_idx n1;
+    while( it.next( n1 ) ){
+      if( scc[ n1 ] != scc[ n2 ] ){ leaves[ scc[ n1 ] ] = 1; }
+    }
+  }
+  node_idx bottom = 0;
+  for( node_idx cc = 0; cc < nr_scc; ++cc ){ if( !leaves[ cc ] ){ ++bottom; } }
+  free_column( scc ); free_column( leaves );
+
+  /* The lists of the hash table */
+  std::vector< unsigned long long > chains;
+  for( node_idx hi = 0; hi < hash_size; ++hi ){
+    node_idx len = 0;
+    for( node_idx ni = hash_tbl[ hi ]; ni; ni = nodes.h_next[ ni ] ){ ++len; }
+    stats_add( chains, len );
+  }
+
+  /* Write the object. */
+  std::fprintf( out, "{\n  \"states\": %llu,\n  \"edges\": %llu,\n"
+    "  \"state_words\": %u,\n  \"terminal_states\": %llu,\n",
+    (unsigned long long)( nn - 1 ), (unsigned long long)nr_edges,
+    state_var::nr_words, (unsigned long long)terminal
+  );
+  std::fprintf( out, "  \"levels\": [" );
+  for( size_t ii = 0; ii < levels.size(); ++ii ){
+    std::fprintf( out, "%s%llu", ii ? "," : "", levels[ ii ] );
+  }
+  std::fprintf( out, "],\n" );
+  stats_hist( out, "out_degrees", out_deg );
+  stats_hist( out, "in_degrees", in_deg );
+  std::fprintf( out, "  \"sccs\": %llu,\n  \"largest_scc\": %llu,\n"
+    "  \"terminal_sccs\": %llu,\n", (unsigned long long)nr_scc,
+    (unsigned long long)biggest, (unsigned long long)bottom
+  );
+  stats_hist( out, "scc_sizes", scc_size );
+  std::fprintf( out, "  \"hash_bits\": %u,\n", hash_bits );
+  stats_hist( out, "hash_chains", chains, true );
+  std::fprintf( out, "}\n" );
+  if( out != stdout ){ std::fclose( out ); } else{ std::fflush( out ); }
+}
+#endif
+
+
+/* Saving and loading the state space */
+/* The file starts with the following header. It is followed by the hash
+  table, the columns h_next, prev, and e_cnt (if progress checking is on) of
+  the nodes, the state data, and the ie_end column and the incoming edges if
+  they have been constructed. The whole file is accessed via a memory
+  mapping. Node and edge numbers are stored as node_idx and edge_idx, whose
+  width is part of the fingerprint. */
+const unsigned ckpt_version = 3;
+struct ckpt_head{
+  char magic[8];        // "ASSETckp"
+  unsigned version;     // version of the file format
+  unsigned fprint;      // fingerprint of the model and the analysis settings
+  unsigned nr_words, hash_bits;
+  unsigned long long nr_nodes, nr_edges;
+  unsigned long long q_first; // the node from which construction continues
+  unsigned has_iedges;  // 1 if the incoming edges are in the file
+};
+
+/* Returns a fingerprint of the data layout, so that a file made with another
+  kind of model or incompatible settings is not accepted. */
+unsigned ckpt_fprint(){
+  unsigned fp = state_var::layout() * 1234567 + nr_trans;
+  fp = fp * 1234567 + sizeof( node_idx ) * 16 + sizeof( edge_idx );
+  #ifndef no_progr_chk
+  fp = fp * 1234567 + 3;
+  #endif
+  #ifdef stubborn
+  fp = fp * 1234567 + 1;
+  #endif
+  #ifdef symmetry
+  fp = fp * 1234567 + 2;
+  #endif
+  #ifdef packed_edges
+  fp = fp * 1234567 + 4;
+  #endif
+  return fp;
+}
+
+/* The number of bytes per node in the node columns that are saved */
+#ifdef no_progr_chk
+const size_t ckpt_node_bytes = 2 * sizeof( node_idx );
+#else
+const size_t ckpt_node_bytes = 2 * sizeof( node_idx ) + sizeof( edge_idx );
+#endif
+
+/* Copy nn values of type T of a column to or from the file location pp, and
+  advance pp past them. */
+template< class T, class Col >
+void ckpt_put( char *&pp, const Col &col, node_idx nn ){
+  T *up = (T *)pp;
+  for( node_idx ii = 0; ii < nn; ++ii ){ up[ ii ] = col[ ii ]; }
+  pp += sizeof( T ) * nn;
+}
+template< class T, class Col >
+void ckpt_get( const char *&pp, Col &col, node_idx nn ){
+  const T *up = (const T *)pp;
+  col.resize( nn );
+  for( node_idx ii = 0; ii < nn; ++ii ){ col[ ii ] = up[ ii ]; }
+  pp += sizeof( T ) * nn;
+}
+
+#ifdef save_file
+void save_state_space(){
+  bool has_ie = false;
+  #ifndef no_progr_chk
+  #ifndef packed_edges
+  #ifndef edge_file
+  has_ie = iedges;
+  #endif
+  #endif
+  #endif
+  node_idx nr_nodes = nodes.size(); unsigned nr_words = state_var::nr_words;
+  size_t
+    sz_hash = sizeof( node_idx ) * hash_size,
+    sz_nodes = ckpt_node_bytes * nr_nodes,
+    sz_st = sizeof( unsigned ) * ( nr_nodes + 1 ) * nr_words,
+    sz_ie = has_ie ?
+      sizeof( edge_idx ) * nr_nodes + sizeof( node_idx ) * nr_edges : 0,
+    sz_all = sizeof( ckpt_head ) + sz_hash + sz_nodes + sz_st + sz_ie;
+
+  /* Create the file and map it to memory. */
+  int fd = open( save_file, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+  if( fd < 0 ){ err_msg = "Cannot create save file"; return; }
+  if( ftruncate( fd, sz_all ) ){
+    close( fd ); err_msg = "Cannot extend save file"; return;
+  }
+  char *mp = (char *)mmap( 0, sz_all, PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+  if( mp == MAP_FAILED ){ err_msg = "Cannot map save file"; return; }
+
+  /* Copy the header and the data structures to the file. */
+  ckpt_head hd;
+  std::memcpy( hd.magic, "ASSETckp", 8 ); hd.version = ckpt_version;
+  hd.fprint = ckpt_fprint(); hd.nr_words = nr_words;
+  hd.hash_bits = hash_bits; hd.nr_nodes = nr_nodes; hd.nr_edges = nr_edges;
+  hd.q_first = bss_stopped ? bss_first : nr_nodes; hd.has_iedges = has_ie;
+  char *pp = mp;
+  std::memcpy( pp, &hd, sizeof( hd ) ); pp += sizeof( hd );
+  std::memcpy( pp, &hash_tbl[0], sz_hash ); pp += sz_hash;
+  ckpt_put< node_idx >( pp, nodes.h_next, nr_nodes );
+  ckpt_put< node_idx >( pp, nodes.prev, nr_nodes );
+  #ifndef no_progr_chk
+  ckpt_put< edge_idx >( pp, nodes.e_cnt, nr_nodes );
+  #endif
+  std::memcpy( pp, &state_var::st_data[0], sz_st ); pp += sz_st;
+  #ifndef no_progr_chk
+  if( has_ie ){
+    ckpt_put< edge_idx >( pp, nodes.ie_end, nr_nodes );
+    std::memcpy( pp, iedges, sizeof( node_idx ) * nr_edges );
+  }
+  #endif
+  if( munmap( mp, sz_all ) ){ err_msg = "Cannot write save file"; }
+
+}
+#endif
+
+#ifdef load_file
+
+/* Tells whether a saved hash table of 2^bits entries can be used. With
+  mem_budget, the size of the hash table is taken from the file. */
+bool ckpt_hash_ok( unsigned bits ){
+  #ifdef mem_budget
+  #ifndef hash_count
+  if( bits != hash_bits && bits < 8 * sizeof( node_idx ) - 1 ){
+    hash_alloc( bits );
+  }
+  #endif
+  #endif
+  return bits == hash_bits;
+}
+
+void load_state_space(){
+
+  /* Map the file to memory and check its header. */
+  int fd = open( load_file, O_RDONLY );
+  if( fd < 0 ){ err_msg = "Cannot open load file"; return; }
+  struct stat fs;
+  if( fstat( fd, &fs ) || size_t( fs.st_size ) < sizeof( ckpt_head ) ){
+    close( fd ); err_msg = "Load file is too short"; return;
+  }
+  size_t sz_all = fs.st_size;
+  const char *mp =
+    (const char *)mmap( 0, sz_all, PROT_READ, MAP_PRIVATE, fd, 0 );
+  close( fd );
+  if( mp == MAP_FAILED ){ err_msg = "Cannot map load file"; return; }
+  ckpt_head hd; std::memcpy( &hd, mp, sizeof( hd ) );
+  if( std::memcmp( hd.magic, "ASSETckp", 8 ) ){
+    err_msg = "Load file is not an ASSET save file";
+  }else if( hd.version != ckpt_version ){
+    err_msg = "Load file has a wrong version";
+  }else if(
+    hd.fprint != ckpt_fprint() || hd.nr_words != state_var::nr_words
+  ){
+    err_msg = "Load file was made from a different model or settings";
+  }else if( !ckpt_hash_ok( hd.hash_bits ) ){
+    err_msg = "Load file was made with a different hash_count";
+  }
+  #ifdef no_progr_chk
+  else if( hd.has_iedges ){
+    err_msg = "Load file contains edges but progress checking is off";
+  }
+  #endif
+  #ifdef packed_edges
+  else if( hd.has_iedges ){
+    err_msg = "Load file contains edges that packed_edges cannot use";
+  }
+  #endif
+  #ifdef edge_file
+  else if( hd.has_iedges ){
+    err_msg = "Load file contains edges that edge_file cannot use";
+  }
+  #endif
+  size_t
+    sz_hash = sizeof( node_idx ) * hash_size,
+    sz_nodes = ckpt_node_bytes * hd.nr_nodes,
+    sz_st = sizeof( unsigned ) * ( hd.nr_nodes + 1 ) * hd.nr_words,
+    sz_ie = hd.has_iedges ?
+      sizeof( edge_idx ) * hd.nr_nodes + sizeof( node_idx ) * hd.nr_edges : 0;
+  if(
+    !err_msg &&
+    sizeof( ckpt_head ) + sz_hash + sz_nodes + sz_st + sz_ie != sz_all
+  ){ err_msg = "Load file has a wrong size"; }
+  if( err_msg ){ munmap( (void *)mp, sz_all ); return; }
+
+  /* Copy the data structures from the file. */
+  const char *pp = mp + sizeof( hd );
+  std::memcpy( &hash_tbl[0], pp, sz_hash ); pp += sz_hash;
+  ckpt_get< node_idx >( pp, nodes.h_next, hd.nr_nodes );
+  ckpt_get< node_idx >( pp, nodes.prev, hd.nr_nodes );
+  #ifndef no_progr_chk
+  ckpt_get< edge_idx >( pp, nodes.e_cnt, hd.nr_nodes );
+  #endif
+  state_var::st_data.resize( ( hd.nr_nodes + 1 ) * hd.nr_words );
+  std::memcpy( &state_var::st_data[0], pp, sz_st ); pp += sz_st;
+  nr_edges = hd.nr_edges; bss_first = hd.q_first;
+  #ifndef no_progr_chk
+  #ifndef packed_edges
+  #ifndef edge_file
+  if( hd.has_iedges ){
+    ckpt_get< edge_idx >( pp, nodes.ie_end, hd.nr_nodes );
+    iedges = new node_idx[ nr_edges ];
+    std::memcpy( iedges, pp, sizeof( node_idx ) * nr_edges );
+  }
+  #endif
+  #endif
+  #endif
+  munmap( (void *)mp, sz_all );
+
+}
+#endif
+
+
+/* Compositional verification */
+/* Each component is explored alone from the initial state, by firing only
+  its own local transitions. An edge is labelled with the action of the
+  transition, 0 meaning invisible. A local state where the component may
+  terminate gets an edge labelled by the termination action cmp_tick to a
+  sink state. Then the actions that the remaining components do not use are
+  hidden, except the progress actions and cmp_tick, and the result is reduced
+  with the branching bisimulation above. The components are composed one by
+  one in their order, synchronizing on the actions that both sides use, and
+  the result is hidden and reduced after each step. The deadlock and
+  progress checks are made on the final reduced state space, in which the
+  sink states are labelled to keep them apart from deadlocks. */
+#ifdef components
+unsigned cmp_tick;    // the termination action, bigger than the others
+
+/* The edges of a component or composition, sorted by their source states */
+struct cmp_edge{
+  node_idx src; unsigned act; node_idx tgt;
+};
+inline bool operator <( const cmp_edge &e1, const cmp_edge &e2 ){
+  if( e1.src != e2.src ){ return e1.src < e2.src; }
+  if( e1.act != e2.act ){ return e1.act < e2.act; }
+  return e1.tgt < e2.tgt;
+}
+inline bool operator ==( const cmp_edge &e1, const cmp_edge &e2 ){
+  return e1.src == e2.src && e1.act == e2.act && e1.tgt == e2.tgt;
+}
+
+/* A state space with states 1, ..., nr_states, of which 1 is initial, and
+  the set of its visible actions */
+struct cmp_lts{
+  node_idx nr_states;
+  std::vector< cmp_edge > edges;
+  std::vector< char > alpha;
+};
+
+/* Constructs the local state space of component cp. Its local states are
+  kept as whole states, in which the variables of the other components have
+  their initial values. */
+void cmp_local( unsigned cp, cmp_lts &lts ){
+  std::map< std::vector< unsigned >, node_idx > seen;
+  std::vector< std::vector< unsigned > > states( 1 );
+  state_row( 1, states[0], false ); seen[ states[0] ] = 1;
+  unsigned nr_tr = model::nr_local( cp );
+  bool has_sink = false;
+  std::vector< unsigned > words;
+  for( node_idx ni = 1; ni <= states.size(); ++ni ){
+    for( unsigned tr = 0; tr < nr_tr; ++tr ){
+      state_row( 0, states[ ni-1 ], true ); use_state( 0 );
+      unsigned act = 0;
+      if( !model::fire_local( cp, tr, act ) && !err_msg ){ continue; }
+      if( !err_msg && act >= cmp_tick ){
+        err_msg = "Action number out of range";
+      }else if( !err_msg && act && !model::uses_action( cp, act ) ){
+        err_msg = "Action is not in the alphabet of the component";
+      }
+      if( err_msg ){ return; }
+      state_row( 0, words, false );
+      std::pair< std::map< std::vector< unsigned >, node_idx >::iterator,
+        bool > ins = seen.insert( std::make_pair( words, states.size() + 1 ) );
+      if( ins.second ){
+        if( states.size() >= stop_count ){
+          err_msg = "Too many local states"; return;
+        }
+        states.push_back( words );
+      }
+      cmp_edge ed = { ni, act, ins.first->second };
+      lts.edges.push_back( ed );
+    }
+    state_row( 0, states[ ni-1 ], true ); use_state( 0 );
+    if( model::local_final( cp ) ){
+      cmp_edge ed = { ni, cmp_tick, 0 };   // the sink gets its number later
+      lts.edges.push_back( ed ); has_sink = true;
+    }
+  }
+  lts.nr_states = states.size() + has_sink;
+  for( size_t ei = 0; ei < lts.edges.size(); ++ei ){
+    if( !lts.edges[ ei ].tgt ){ lts.edges[ ei ].tgt = lts.nr_states; }
+  }
+  std::sort( lts.edges.begin(), lts.edges.end() );
+  lts.edges.erase(
+    std::unique( lts.edges.begin(), lts.edges.end() ), lts.edges.end()
+  );
+  lts.alpha.assign( cmp_tick + 1, 0 ); lts.alpha[ cmp_tick ] = 1;
+  for( unsigned act = 1; act < cmp_tick; ++act ){
+    lts.alpha[ act ] = model::uses_action( cp, act );
+  }
+}
+
+/* Tells whether an action must stay visible in the progress checks. */
+bool cmp_progress( unsigned act ){
+  #ifdef chk_may_progress
+  if( model::is_may_action( act ) ){ return true; }
+  #endif
+  #ifdef chk_must_progress
+  if( model::is_must_action( act ) ){ return true; }
+  #endif
+  return act == cmp_tick;
+}
+
+/* Hides the actions that the components after cp do not use. If local,
+  then lts is component cp alone, and the actions of the components before
+  it are kept, too. */
+void cmp_hide( cmp_lts &lts, unsigned cp, bool local ){
+  unsigned nr_cp = model::nr_components();
+  for( unsigned act = 1; act < cmp_tick; ++act ){
+    if( !lts.alpha[ act ] || cmp_progress( act ) ){ continue; }
+    bool used = false;
+    for( unsigned c2 = local ? 0 : cp + 1; !used && c2 < nr_cp; ++c2 ){
+      used = c2 != cp && model::uses_action( c2, act );
+    }
+    if( !used ){ lts.alpha[ act ] = 0; }
+  }
+  for( size_t ei = 0; ei < lts.edges.size(); ++ei ){
+    if( !lts.alpha[ lts.edges[ ei ].act ] ){ lts.edges[ ei ].act = 0; }
+  }
+}
+
+/* Finds the incoming edges of the states, in the form used by
+  bisim_blocks. */
+void cmp_in_edges(
+  const cmp_lts &lts, std::vector< edge_idx > &ie_end,
+  std::vector< node_idx > &iedges, std::vector< unsigned > &etr
+){
+  node_idx nn = lts.nr_states + 1;
+  ie_end.assign( nn, 0 );
+  for( size_t ei = 0; ei < lts.edges.size(); ++ei ){
+    ++ie_end[ lts.edges[ ei ].tgt ];
+  }
+  for( node_idx ni = 1; ni < nn; ++ni ){ ie_end[ ni ] += ie_end[ ni-1 ]; }
+  iedges.resize( lts.edges.size() ); etr.resize( lts.edges.size() );
+  std::vector< edge_idx > pos( ie_end );
+  for( size_t ei = 0; ei < lts.edges.size(); ++ei ){
+    const cmp_edge &ed = lts.edges[ ei ];
+    edge_idx ii = --pos[ ed.tgt ];
+    iedges[ ii ] = ed.src; etr[ ii ] = ed.act;
+  }
+}
 
-        /* Extract the transition and its next obligation neighbour. */
-        unsigned t1 = stub_dfs[ dfs_cnt-1 ], sm1 = stub_min[ t1 ];
-        stb_tr = &stub_try[ t1 ]; stb_called = false;
-        model::next_stubborn( t1 );
-        if( err_msg ){
-          report_error( q_first, "Stubborn set error" ); return;
-        }
-        unsigned t2 = stub_try[ t1 ];
-
-        /* If no more neighbours, then backtrack. */
-        if( t2 == ~0u ){
-          watchdog = 0; --dfs_cnt;
-
-          /* If strong component is ready, mark and try its transitions. */
-          if( stub_scc[ sm1 ] == t1 ){
-            for( unsigned ii = sm1; ii < scc_cnt; ++ii ){
-              stub_min[ stub_scc[ ii ] ] = ~0u;
-              some_fired |= try_transition( q_first, stub_scc[ ii ] );
-              if( err_msg ){ return; }
-            }
-            if( some_fired ){ break; }
-            scc_cnt = sm1;
-          }
+/* Tells which states are sinks, that is, targets of termination edges. */
+void cmp_sinks( const cmp_lts &lts, std::vector< unsigned long long > &sink ){
+  sink.assign( lts.nr_states + 1, 0 );
+  for( size_t ei = 0; ei < lts.edges.size(); ++ei ){
+    if( lts.edges[ ei ].act == cmp_tick ){ sink[ lts.edges[ ei ].tgt ] = 1; }
+  }
+}
 
-          /* Otherwise backward-propagate the minimum index, if possible. */
-          else if( dfs_cnt ){
-            t2 = stub_dfs[ dfs_cnt-1 ];
-            if( stub_min[ t2 ] > sm1 ){ stub_min[ t2 ] = sm1; }
-          }
+/* Replaces the state space by its quotient. The blocks are numbered in the
+  order of their first states, so the initial state stays 1. */
+void cmp_minimize( cmp_lts &lts ){
+  if( lts.edges.empty() ){ return; }
+  std::vector< edge_idx > ie_end;
+  std::vector< node_idx > iedges, sblock;
+  std::vector< unsigned > etr;
+  std::vector< unsigned long long > label;
+  std::vector< char > bdiv;
+  cmp_in_edges( lts, ie_end, iedges, etr ); cmp_sinks( lts, label );
+  node_idx nb = bisim_blocks(
+    lts.nr_states + 1, &ie_end[0], &iedges[0], &etr[0], 0, label, sblock,
+    bdiv
+  );
+  std::vector< node_idx > bnr( nb );
+  node_idx cnt = 0;
+  for( node_idx ni = 1; ni <= lts.nr_states; ++ni ){
+    if( !bnr[ sblock[ ni ] ] ){ bnr[ sblock[ ni ] ] = ++cnt; }
+  }
+  std::vector< cmp_edge > edges;
+  for( size_t ei = 0; ei < lts.edges.size(); ++ei ){
+    cmp_edge ed = lts.edges[ ei ];
+    ed.src = bnr[ sblock[ ed.src ] ]; ed.tgt = bnr[ sblock[ ed.tgt ] ];
+    if( !ed.act && ed.src == ed.tgt ){ continue; }
+    edges.push_back( ed );
+  }
+  for( node_idx bb = 0; bb < nb; ++bb ){
+    if( bdiv[ bb ] ){
+      cmp_edge ed = { bnr[ bb ], 0, bnr[ bb ] }; edges.push_back( ed );
+    }
+  }
+  std::sort( edges.begin(), edges.end() );
+  edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+  lts.edges.swap( edges ); lts.nr_states = nb;
+}
 
-        }
+/* Returns the index of the first outgoing edge of each state. */
+void cmp_out_beg( const cmp_lts &lts, std::vector< size_t > &beg ){
+  beg.assign( lts.nr_states + 2, 0 );
+  for( size_t ei = 0; ei < lts.edges.size(); ++ei ){
+    ++beg[ lts.edges[ ei ].src + 1 ];
+  }
+  for( node_idx ni = 1; ni <= lts.nr_states + 1; ++ni ){
+    beg[ ni ] += beg[ ni-1 ];
+  }
+}
+
+/* Constructs the reachable part of the parallel composition of l1 and l2.
+  Actions in both alphabets are synchronized, the others interleave. */
+typedef std::pair< node_idx, node_idx > cmp_pair;
+struct cmp_builder{
+  std::map< cmp_pair, node_idx > seen;
+  std::vector< cmp_pair > states;
+  cmp_lts &lts;
+  cmp_builder( cmp_lts &lts ): lts( lts ){}
+
+  /* Adds an edge from state ni to the pair, and the pair if it is new. */
+  void add( node_idx ni, unsigned act, node_idx s1, node_idx s2 ){
+    std::pair< std::map< cmp_pair, node_idx >::iterator, bool > ins =
+      seen.insert( std::make_pair( cmp_pair( s1, s2 ), states.size() + 1 ) );
+    if( ins.second ){
+      if( states.size() >= stop_count ){
+        err_msg = "Too many states in a composition"; return;
+      }
+      states.push_back( cmp_pair( s1, s2 ) );
+    }
+    cmp_edge ed = { ni, act, ins.first->second };
+    lts.edges.push_back( ed );
+  }
 
-        /* If the neighbour has not been seen, enter it. */
-        else if( stub_found[ t2 ] < stub_nr ){
-          watchdog = 0; stub_found[ t2 ] = stub_nr; stub_try[ t2 ] = ~0u;
-          stub_min[ t2 ] = scc_cnt;
-          stub_dfs[ dfs_cnt++ ] = stub_scc[ scc_cnt++ ] = t2;
+};
+
+void cmp_product( const cmp_lts &l1, const cmp_lts &l2, cmp_lts &lts ){
+  std::vector< size_t > beg1, beg2;
+  cmp_out_beg( l1, beg1 ); cmp_out_beg( l2, beg2 );
+  lts.edges.clear();
+  cmp_builder bld( lts );
+  bld.add( 0, 0, 1, 1 ); lts.edges.clear();
+  for( node_idx ni = 1; !err_msg && ni <= bld.states.size(); ++ni ){
+    node_idx s1 = bld.states[ ni-1 ].first, s2 = bld.states[ ni-1 ].second;
+    for( size_t e1 = beg1[ s1 ]; e1 < beg1[ s1 + 1 ]; ++e1 ){
+      const cmp_edge &ed = l1.edges[ e1 ];
+      if( !l2.alpha[ ed.act ] ){ bld.add( ni, ed.act, ed.tgt, s2 ); continue; }
+      for( size_t e2 = beg2[ s2 ]; e2 < beg2[ s2 + 1 ]; ++e2 ){
+        if( l2.edges[ e2 ].act == ed.act ){
+          bld.add( ni, ed.act, ed.tgt, l2.edges[ e2 ].tgt );
         }
+      }
+    }
+    for( size_t e2 = beg2[ s2 ]; e2 < beg2[ s2 + 1 ]; ++e2 ){
+      const cmp_edge &ed = l2.edges[ e2 ];
+      if( !l1.alpha[ ed.act ] ){ bld.add( ni, ed.act, s1, ed.tgt ); }
+    }
+  }
+  lts.nr_states = bld.states.size();
+  std::sort( lts.edges.begin(), lts.edges.end() );
+  lts.edges.erase(
+    std::unique( lts.edges.begin(), lts.edges.end() ), lts.edges.end()
+  );
+  lts.alpha.assign( cmp_tick + 1, 0 );
+  for( unsigned act = 1; act <= cmp_tick; ++act ){
+    lts.alpha[ act ] = l1.alpha[ act ] || l2.alpha[ act ];
+  }
+}
 
-        /* Otherwise just backward-propagate the minimum index. */
-        else{
-          if( ++watchdog > nr_trans ){
-            err_msg = "Same element twice in stb list";
-            report_error( q_first, "Stubborn set error" ); return;
-          }
-          if( sm1 > stub_min[ t2 ] ){ stub_min[ t1 ] = stub_min[ t2 ]; }
+/* Prints the visible actions on the shortest path to state ni. */
+void cmp_history(
+  const std::vector< node_idx > &pred, const std::vector< unsigned > &pact,
+  node_idx ni
+){
+  if( ni <= 1 ){ return; }
+  cmp_history( pred, pact, pred[ ni ] );
+  if( pact[ ni ] == cmp_tick ){ std::cout << "terminate\n"; }
+  else if( pact[ ni ] ){ model::print_action( pact[ ni ] ); }
+}
+
+/* Makes the deadlock and progress checks on the final state space. States
+  are checked in breadth-first order, so that the counterexample is short. */
+void cmp_check( const cmp_lts &lts ){
+  node_idx nn = lts.nr_states + 1;
+  std::vector< size_t > beg;
+  std::vector< edge_idx > ie_end;
+  std::vector< node_idx > iedges, pred( nn ), ord( 1, 1 );
+  std::vector< unsigned > etr, pact( nn );
+  std::vector< unsigned long long > sink;
+  cmp_out_beg( lts, beg ); cmp_in_edges( lts, ie_end, iedges, etr );
+  cmp_sinks( lts, sink );
+  pred[ 1 ] = 1;
+  for( node_idx ii = 0; ii < ord.size(); ++ii ){
+    for( size_t ei = beg[ ord[ ii ] ]; ei < beg[ ord[ ii ] + 1 ]; ++ei ){
+      node_idx n2 = lts.edges[ ei ].tgt;
+      if( pred[ n2 ] ){ continue; }
+      pred[ n2 ] = ord[ ii ]; pact[ n2 ] = lts.edges[ ei ].act;
+      ord.push_back( n2 );
+    }
+  }
+
+  /* Deadlocks are terminal states other than sinks. */
+  #ifdef chk_deadlock
+  node_idx bad = 0;
+  for( node_idx ii = 0; !bad && ii < ord.size(); ++ii ){
+    node_idx ni = ord[ ii ];
+    if( beg[ ni ] == beg[ ni + 1 ] && !sink[ ni ] ){ bad = ni; }
+  }
+  if( bad ){
+    std::cout << clean_eol; cmp_history( pred, pact, bad );
+    err_msg = ""; report_error( 0, "Illegal deadlock" ); return;
+  }
+  #endif
+
+  /* A may progress action or a terminal state must be reachable from every
+    state. */
+  #ifdef chk_may_progress
+  {
+    std::vector< char > good( nn );
+    std::vector< node_idx > work;
+    for( node_idx ni = 1; ni < nn; ++ni ){
+      bool gd = false;
+      #ifndef dl_not_may
+      gd = beg[ ni ] == beg[ ni + 1 ];
+      #endif
+      for( size_t ei = beg[ ni ]; !gd && ei < beg[ ni + 1 ]; ++ei ){
+        gd = model::is_may_action( lts.edges[ ei ].act );
+      }
+      if( gd ){ good[ ni ] = 1; work.push_back( ni ); }
+    }
+    while( !work.empty() ){
+      node_idx ni = work.back(); work.pop_back();
+      for( edge_idx ei = ie_end[ ni-1 ]; ei < ie_end[ ni ]; ++ei ){
+        if( !good[ iedges[ ei ] ] ){
+          good[ iedges[ ei ] ] = 1; work.push_back( iedges[ ei ] );
         }
+      }
+    }
+    node_idx bad = 0;
+    for( node_idx ii = 0; !bad && ii < ord.size(); ++ii ){
+      if( !good[ ord[ ii ] ] ){ bad = ord[ ii ]; }
+    }
+    if( bad ){
+      std::cout << clean_eol; cmp_history( pred, pact, bad );
+      err_msg = "no may progress action is reachable";
+      report_error( 0, "May-type non-progress error" ); return;
+    }
+  }
+  #endif
 
+  /* Every cycle and every terminal state must contain a must progress
+    action. A state is safe, if every path from it that avoids must progress
+    actions is finite and ends in an acceptable terminal state. */
+  #ifdef chk_must_progress
+  {
+    std::vector< size_t > cnt( nn );
+    std::vector< char > safe( nn );
+    std::vector< node_idx > work;
+    for( node_idx ni = 1; ni < nn; ++ni ){
+      bool must = false;
+      for( size_t ei = beg[ ni ]; ei < beg[ ni + 1 ]; ++ei ){
+        if( model::is_must_action( lts.edges[ ei ].act ) ){ must = true; }
+        else{ ++cnt[ ni ]; }
+      }
+      #ifndef dl_not_must
+      if( beg[ ni ] == beg[ ni + 1 ] ){ must = true; }
+      #endif
+      if( !cnt[ ni ] && must ){ safe[ ni ] = 1; work.push_back( ni ); }
+    }
+    while( !work.empty() ){
+      node_idx ni = work.back(); work.pop_back();
+      for( edge_idx ei = ie_end[ ni-1 ]; ei < ie_end[ ni ]; ++ei ){
+        node_idx n1 = iedges[ ei ];
+        if( model::is_must_action( etr[ ei ] ) || safe[ n1 ] ){ continue; }
+        if( !--cnt[ n1 ] ){ safe[ n1 ] = 1; work.push_back( n1 ); }
+      }
+    }
+    for( node_idx ii = 0; !bad && ii < ord.size(); ++ii ){
+      if( !safe[ ord[ ii ] ] ){ bad = ord[ ii ]; }
+    }
+    if( bad ){
+      std::cout << clean_eol; cmp_history( pred, pact, bad );
+      err_msg = "a cycle or terminal state without must progress actions"
+        " is reachable";
+      report_error( 0, "Must-type non-progress error" ); return;
+    }
+  }
+  #endif
+
+}
+
+/* Constructs, reduces, and composes the components, and checks the
+  result. */
+void verify_components(){
+  cmp_tick = model::nr_actions();
+  unsigned nr_cp = model::nr_components();
+  if( !nr_cp ){ err_msg = "No components"; return; }
+  cmp_lts lts, loc, prod;
+  for( unsigned cp = 0; cp < nr_cp; ++cp ){
+    loc.edges.clear(); cmp_local( cp, loc );
+    if( err_msg ){ report_error( 0, "Component error" ); return; }
+    std::cout << clean_eol << "Component " << cp << ": " << loc.nr_states
+      << " states, " << loc.edges.size() << " edges";
+    cmp_hide( loc, cp, true ); cmp_minimize( loc );
+    std::cout << ", " << loc.nr_states << " after minimization\n";
+    if( !cp ){
+      lts.nr_states = loc.nr_states;
+      lts.edges.swap( loc.edges ); lts.alpha.swap( loc.alpha );
+    }else{
+      cmp_product( lts, loc, prod );
+      if( err_msg ){ report_error( 0, "Composition error" ); return; }
+      std::cout << "Composition 0-" << cp << ": " << prod.nr_states
+        << " states, " << prod.edges.size() << " edges";
+      cmp_hide( prod, cp, false ); cmp_minimize( prod );
+      std::cout << ", " << prod.nr_states << " after minimization\n";
+      lts.nr_states = prod.nr_states;
+      lts.edges.swap( prod.edges ); lts.alpha.swap( prod.alpha );
+    }
+  }
+  cmp_check( lts );
+  std::cout << lts.nr_states << " states, " << lts.edges.size()
+    << " edges\n";
+}
+#endif
+
+
+/* Symbolic reachability */
+/* With symbolic, sets of states are represented as binary decision diagrams
+  (BDDs) over the bits of the state. Bit b of word w is variable 2 * ( 32 * w
+  + b ), and its value after a transition is the next variable. The relation
+  of a transition is learned by firing it in states whose key bits (see
+  "Declared variables of the transitions") have the values that occur in the
+  newly found states. It consists of the values of the key bits before and
+  after. A transition that declares no variables has all bits as its key.
+  The states are found in breadth-first rings, and a shortest counterexample
+  is picked backwards from them via preimages. check_state is learned like a
+  transition if check_state_vars declares its variables, and is otherwise
+  called in each new state. check_deadlock is called in the reachable states
+  in which no transition is enabled. The BDD nodes are never freed. */
+#ifdef symbolic
+typedef unsigned bdd;                 // 0 = false, 1 = true, or a node
+struct bdd_node{
+  unsigned var; bdd lo, hi;
+};
+std::vector< bdd_node > bdd_nodes;
+std::vector< bdd > bdd_uniq;          // hash table of the nodes, 0 = empty
+struct bdd_memo_ent{
+  unsigned op; bdd a, b; unsigned c; bdd r;
+};
+std::vector< bdd_memo_ent > bdd_memo; // results of operations, op 0 = empty
+const unsigned bdd_memo_bits = 20;
+std::vector< std::vector< char > > bdd_sets;  // sets of variables
+enum{ op_and = 1, op_or, op_diff, op_andex, op_shift };
+
+inline unsigned bdd_hash( unsigned aa, unsigned bb, unsigned cc ){
+  unsigned hh = aa * 0x9e3779b1u ^ bb * 0x85ebca6bu ^ cc * 0xc2b2ae35u;
+  return hh ^ hh >> 15;
+}
+
+/* Creates the terminals and the tables. */
+void bdd_init(){
+  bdd_node nd = { ~0u, 0, 0 };
+  bdd_nodes.assign( 2, nd );
+  bdd_uniq.assign( 1u << 16, 0 );
+  bdd_memo_ent me = { 0, 0, 0, 0, 0 };
+  bdd_memo.assign( 1u << bdd_memo_bits, me );
+}
+
+/* Returns the node with the given contents, creating it if necessary. */
+bdd bdd_mk( unsigned var, bdd lo, bdd hi ){
+  if( lo == hi ){ return lo; }
+  unsigned mask = bdd_uniq.size() - 1, hh = bdd_hash( var, lo, hi ) & mask;
+  for( ; bdd_uniq[ hh ]; hh = ( hh + 1 ) & mask ){
+    const bdd_node &nd = bdd_nodes[ bdd_uniq[ hh ] ];
+    if( nd.var == var && nd.lo == lo && nd.hi == hi ){ return bdd_uniq[ hh ]; }
+  }
+  if( bdd_nodes.size() >= stop_count ){
+    err_msg = "Too many BDD nodes"; return 0;
+  }
+  bdd_uniq[ hh ] = bdd_nodes.size();
+  bdd_node nd = { var, lo, hi }; bdd_nodes.push_back( nd );
+
+  /* Keep the hash table at most half full. */
+  if( 2 * bdd_nodes.size() > bdd_uniq.size() ){
+    bdd_uniq.assign( 2 * bdd_uniq.size(), 0 ); mask = bdd_uniq.size() - 1;
+    for( bdd nn = 2; nn < bdd_nodes.size(); ++nn ){
+      const bdd_node &n2 = bdd_nodes[ nn ];
+      unsigned h2 = bdd_hash( n2.var, n2.lo, n2.hi ) & mask;
+      while( bdd_uniq[ h2 ] ){ h2 = ( h2 + 1 ) & mask; }
+      bdd_uniq[ h2 ] = nn;
+    }
+  }
+  return bdd_nodes.size() - 1;
+}
+
+/* Looks up and stores results of operations. */
+inline bdd_memo_ent &bdd_memo_at( unsigned op, bdd aa, bdd bb, unsigned cc ){
+  return bdd_memo[
+    bdd_hash( aa, bb, cc << 3 | op ) & ( ( 1u << bdd_memo_bits ) - 1 )
+  ];
+}
+inline bool bdd_memo_get( unsigned op, bdd aa, bdd bb, unsigned cc, bdd &rr ){
+  const bdd_memo_ent &me = bdd_memo_at( op, aa, bb, cc );
+  if( me.op != op || me.a != aa || me.b != bb || me.c != cc ){ return false; }
+  rr = me.r; return true;
+}
+inline void bdd_memo_put( unsigned op, bdd aa, bdd bb, unsigned cc, bdd rr ){
+  bdd_memo_ent me = { op, aa, bb, cc, rr };
+  bdd_memo_at( op, aa, bb, cc ) = me;
+}
+
+/* Conjunction, disjunction, and difference (aa and not bb) */
+bdd bdd_apply( unsigned op, bdd aa, bdd bb ){
+  if( op == op_and ){
+    if( !aa || !bb ){ return 0; }
+    if( aa == 1 || aa == bb ){ return bb; }
+    if( bb == 1 ){ return aa; }
+  }else if( op == op_or ){
+    if( aa == 1 || bb == 1 ){ return 1; }
+    if( !aa || aa == bb ){ return bb; }
+    if( !bb ){ return aa; }
+  }else{
+    if( !aa || bb == 1 || aa == bb ){ return 0; }
+    if( !bb ){ return aa; }
+  }
+  if( op != op_diff && aa > bb ){ bdd tt = aa; aa = bb; bb = tt; }
+  bdd rr;
+  if( bdd_memo_get( op, aa, bb, 0, rr ) ){ return rr; }
+  const bdd_node &na = bdd_nodes[ aa ], &nb = bdd_nodes[ bb ];
+  unsigned var = na.var < nb.var ? na.var : nb.var;
+  bdd
+    a0 = na.var == var ? na.lo : aa, a1 = na.var == var ? na.hi : aa,
+    b0 = nb.var == var ? nb.lo : bb, b1 = nb.var == var ? nb.hi : bb;
+  bdd r0 = bdd_apply( op, a0, b0 );
+  rr = bdd_mk( var, r0, bdd_apply( op, a1, b1 ) );
+  bdd_memo_put( op, aa, bb, 0, rr ); return rr;
+}
+
+/* Conjunction of aa and bb, with the variables of set number st quantified
+  existentially */
+bdd bdd_and_exists( bdd aa, bdd bb, unsigned st ){
+  if( !aa || !bb ){ return 0; }
+  if( aa == 1 && bb == 1 ){ return 1; }
+  if( aa > bb ){ bdd tt = aa; aa = bb; bb = tt; }
+  bdd rr;
+  if( bdd_memo_get( op_andex, aa, bb, st, rr ) ){ return rr; }
+  const bdd_node &na = bdd_nodes[ aa ], &nb = bdd_nodes[ bb ];
+  unsigned var = na.var < nb.var ? na.var : nb.var;
+  bdd
+    a0 = na.var == var ? na.lo : aa, a1 = na.var == var ? na.hi : aa,
+    b0 = nb.var == var ? nb.lo : bb, b1 = nb.var == var ? nb.hi : bb;
+  bdd r0 = bdd_and_exists( a0, b0, st );
+  if( bdd_sets[ st ][ var ] ){
+    if( r0 != 1 ){
+      rr = bdd_apply( op_or, r0, bdd_and_exists( a1, b1, st ) );
+    }else{ rr = 1; }
+  }else{ rr = bdd_mk( var, r0, bdd_and_exists( a1, b1, st ) ); }
+  bdd_memo_put( op_andex, aa, bb, st, rr ); return rr;
+}
+
+/* Moves each variable of set number st to the next (if up) or previous
+  variable. No other variable may be in between. */
+bdd bdd_shift( bdd aa, unsigned st, bool up ){
+  if( aa < 2 ){ return aa; }
+  bdd rr;
+  if( bdd_memo_get( op_shift, aa, up, st, rr ) ){ return rr; }
+  const bdd_node &na = bdd_nodes[ aa ];
+  unsigned var = na.var;
+  if( bdd_sets[ st ][ var ] ){ if( up ){ ++var; }else{ --var; } }
+  bdd r0 = bdd_shift( na.lo, st, up );
+  rr = bdd_mk( var, r0, bdd_shift( bdd_nodes[ aa ].hi, st, up ) );
+  bdd_memo_put( op_shift, aa, up, st, rr ); return rr;
+}
+
+/* Returns the conjunction of the given values of the given increasing
+  variables. */
+bdd bdd_cube(
+  const std::vector< unsigned > &vars, const std::vector< char > &vals
+){
+  bdd rr = 1;
+  for( unsigned ii = vars.size(); ii--; ){
+    rr = vals[ ii ] ? bdd_mk( vars[ ii ], 0, rr ) : bdd_mk( vars[ ii ], rr, 0 );
+  }
+  return rr;
+}
+
+/* Adds a set of variables and returns its number. */
+unsigned bdd_new_set( const std::vector< char > &flags ){
+  bdd_sets.push_back( flags ); return bdd_sets.size() - 1;
+}
+
+/* Calls fn for each assignment to the increasing variables vars[ ii ], ...
+  that satisfies aa, whose variables must be among them. Stops if fn returns
+  false, and then returns false. */
+template< class Fn > bool bdd_enum(
+  bdd aa, const std::vector< unsigned > &vars, unsigned ii,
+  std::vector< char > &vals, Fn &fn
+){
+  if( !aa ){ return true; }
+  if( ii == vars.size() ){ return fn( vals ); }
+  bdd a0 = aa, a1 = aa;
+  if( bdd_nodes[ aa ].var == vars[ ii ] ){
+    a0 = bdd_nodes[ aa ].lo; a1 = bdd_nodes[ aa ].hi;
+  }
+  vals[ ii ] = 0;
+  if( !bdd_enum( a0, vars, ii + 1, vals, fn ) ){ return false; }
+  vals[ ii ] = 1; return bdd_enum( a1, vars, ii + 1, vals, fn );
+}
+
+
+/* The symbolic engine */
+struct sym_tr{
+  std::vector< unsigned > kv;       // the variables of the key bits
+  unsigned key_set, nonkey_set, next_set; // the key, the other bits, and
+  bdd rel, seen;                    //   the next key; relation, and learned
+};
+std::vector< sym_tr > sym_trs;      // the transitions and check_state
+std::vector< unsigned > sym_init;   // the initial state
+std::vector< unsigned > sym_vars;   // the variables of all bits
+std::vector< bdd > sym_rings;       // the breadth-first rings
+bdd sym_bad = 0;                    // learned states that check_state rejects
+
+/* Conversions between states and values of variables */
+void sym_words(
+  const std::vector< unsigned > &vars, const std::vector< char > &vals,
+  std::vector< unsigned > &words
+){
+  for( unsigned ii = 0; ii < vars.size(); ++ii ){
+    unsigned bit = vars[ ii ] / 2, mask = 1u << bit % 32;
+    if( vals[ ii ] ){ words[ bit / 32 ] |= mask; }
+    else{ words[ bit / 32 ] &= ~mask; }
+  }
+}
+bdd sym_state( const std::vector< unsigned > &words ){
+  std::vector< char > vals( sym_vars.size() );
+  for( unsigned ii = 0; ii < sym_vars.size(); ++ii ){
+    vals[ ii ] = words[ ii / 32 ] >> ii % 32 & 1;
+  }
+  return bdd_cube( sym_vars, vals );
+}
+
+/* Returns some state in aa, which must not be empty. */
+void sym_pick( bdd aa, std::vector< unsigned > &words ){
+  words.assign( sym_init.size(), 0 );
+  while( aa > 1 ){
+    const bdd_node &nd = bdd_nodes[ aa ];
+    if( nd.lo ){ aa = nd.lo; }
+    else{ words[ nd.var / 64 ] |= 1u << nd.var / 2 % 32; aa = nd.hi; }
+  }
+}
+
+/* Returns the number of states in aa. */
+double sym_count( bdd aa, std::vector< double > &memo ){
+  if( aa < 2 ){ return aa; }
+  if( memo[ aa ] >= 0 ){ return memo[ aa ]; }
+  const bdd_node &nd = bdd_nodes[ aa ];
+  unsigned lev = nd.var / 2, end = sym_vars.size();
+  unsigned l0 = nd.lo < 2 ? end : bdd_nodes[ nd.lo ].var / 2,
+    l1 = nd.hi < 2 ? end : bdd_nodes[ nd.hi ].var / 2;
+  return memo[ aa ] =
+    std::ldexp( sym_count( nd.lo, memo ), l0 - lev - 1 ) +
+    std::ldexp( sym_count( nd.hi, memo ), l1 - lev - 1 );
+}
+double sym_count( bdd aa ){
+  std::vector< double > memo( bdd_nodes.size(), -1. );
+  unsigned lev = aa < 2 ? sym_vars.size() : bdd_nodes[ aa ].var / 2;
+  return std::ldexp( sym_count( aa, memo ), lev );
+}
+void sym_print_count( double cnt ){
+  if( cnt < 1e18 ){ std::cout << (unsigned long long)( cnt + .5 ); }
+  else{ std::cout << cnt; }
+}
+
+/* Fires transition ti (or calls check_state, if ti == nr_trans) in the
+  states given by values of the key, and adds the result to the relation
+  (or to sym_bad). */
+struct sym_learner{
+  unsigned ti;
+  std::vector< unsigned > words, after;
+  bool operator()( const std::vector< char > &vals ){
+    sym_tr &st = sym_trs[ ti ];
+    words = sym_init; sym_words( st.kv, vals, words );
+    state_row( 0, words, true ); use_state( 0 );
+    #ifdef chk_state
+    if( ti == nr_trans ){
+      if( model::check_state() ){ sym_bad = bdd_apply(
+        op_or, sym_bad, bdd_cube( st.kv, vals )
+      ); }
+      return !err_msg;
+    }
+    #endif
+    bool en = model::fire_transition( ti );
+    if( err_msg ){ return false; }
+    state_row( 0, after, false );
+
+    /* Check that only the declared bits changed. */
+    const var_set &vs = tr_sets[ ti ];
+    if( en ){
+      for( unsigned ii = 0; ii < vs.ww.size(); ++ii ){
+        words[ vs.ww[ ii ] ] &= ~vs.wm[ ii ];
+        words[ vs.ww[ ii ] ] |= after[ vs.ww[ ii ] ] & vs.wm[ ii ];
+      }
+    }
+    if( !vs.kw.empty() && words != after ){
+      err_msg = "A transition wrote a variable that it did not declare";
+      return false;
+    }
+
+    /* Add the pair of the key values before and after. */
+    if( en ){
+      std::vector< unsigned > vars( 2 * st.kv.size() );
+      std::vector< char > v2( 2 * st.kv.size() );
+      for( unsigned ii = 0; ii < st.kv.size(); ++ii ){
+        unsigned bit = st.kv[ ii ] / 2;
+        vars[ 2*ii ] = st.kv[ ii ]; vars[ 2*ii + 1 ] = st.kv[ ii ] + 1;
+        v2[ 2*ii ] = vals[ ii ];
+        v2[ 2*ii + 1 ] = after[ bit / 32 ] >> bit % 32 & 1;
+      }
+      st.rel = bdd_apply( op_or, st.rel, bdd_cube( vars, v2 ) );
+    }
+    return !err_msg;
+  }
+};
+
+/* Learns transition or check ti in the key values of states that are new
+  to it. */
+void sym_learn( unsigned ti, bdd states ){
+  sym_tr &st = sym_trs[ ti ];
+  bdd nw = bdd_apply( op_diff,
+    bdd_and_exists( states, 1, st.nonkey_set ), st.seen
+  );
+  st.seen = bdd_apply( op_or, st.seen, nw );
+  std::vector< char > vals( st.kv.size() );
+  sym_learner lr; lr.ti = ti;
+  bdd_enum( nw, st.kv, 0, vals, lr );
+}
+
+/* Returns the states that can be reached from aa by one transition, or the
+  states from which aa can be reached, if back. */
+bdd sym_step( bdd aa, bool back ){
+  bdd rr = 0;
+  for( unsigned tr = 0; !err_msg && tr < nr_trans; ++tr ){
+    sym_tr &st = sym_trs[ tr ];
+    if( back ){
+      rr = bdd_apply( op_or, rr, bdd_and_exists(
+        st.rel, bdd_shift( aa, st.key_set, true ), st.next_set
+      ) );
+    }else{
+      rr = bdd_apply( op_or, rr, bdd_shift(
+        bdd_and_exists( aa, st.rel, st.key_set ), st.next_set, false
+      ) );
+    }
+  }
+  return rr;
+}
+
+/* Prints a shortest path to the state in ring number ri, and reports the
+  error. */
+void sym_report(
+  unsigned ri, const std::vector< unsigned > &words, const char *msg
+){
+  const char *err = err_msg; err_msg = 0;
+  std::vector< std::vector< unsigned > > path( ri + 1 );
+  path[ ri ] = words;
+  for( unsigned ii = ri; ii; --ii ){
+    bdd pre = bdd_apply(
+      op_and, sym_step( sym_state( path[ ii ] ), true ), sym_rings[ ii-1 ]
+    );
+    sym_pick( pre, path[ ii-1 ] );
+  }
+  std::cout << clean_eol;
+  for( unsigned ii = 0; ii <= ri; ++ii ){
+    state_row( 0, path[ ii ], true ); use_state( 0 ); model::print_state();
+  }
+  err_msg = err; report_error( 0, msg );
+}
+
+/* Calls check_state or check_deadlock in each state of aa, until one of them
+  returns an error message. */
+struct sym_checker{
+  bool dl;
+  std::vector< unsigned > words;
+  bool operator()( const std::vector< char > &vals ){
+    words = sym_init; sym_words( sym_vars, vals, words );
+    state_row( 0, words, true ); use_state( 0 );
+    #ifdef chk_state
+    if( !dl ){ err_msg = model::check_state(); }
+    #endif
+    #ifdef chk_deadlock
+    if( dl ){ err_msg = model::check_deadlock(); }
+    #endif
+    return !err_msg;
+  }
+};
+bool sym_check( bdd aa, bool dl, unsigned ri ){
+  std::vector< char > vals( sym_vars.size() );
+  sym_checker ck; ck.dl = dl;
+  if( bdd_enum( aa, sym_vars, 0, vals, ck ) ){ return true; }
+  sym_report( ri, ck.words, dl ? "Illegal deadlock" : "Safety error" );
+  return false;
+}
+
+/* Constructs the reachable states and checks them. */
+void verify_symbolic(){
+  tr_sets_setup();
+  if( err_msg ){ report_error( 0, "Initialization error" ); return; }
+  state_row( 1, sym_init, false );
+  unsigned nr_vars = 64 * sym_init.size();
+  bdd_init();
+  for( unsigned var = 0; var < nr_vars; var += 2 ){ sym_vars.push_back( var ); }
+
+  /* Find the variables of the transitions and of check_state. */
+  sym_trs.resize( nr_trans + 1 );
+  for( unsigned ti = 0; ti <= nr_trans; ++ti ){
+    sym_tr &st = sym_trs[ ti ];
+    std::vector< char > key( nr_vars ), nonkey( nr_vars ), next( nr_vars );
+    const var_set &vs = tr_sets[ ti ];
+    for( unsigned ii = 0; ii < vs.kw.size(); ++ii ){
+      for( unsigned bit = 0; bit < 32; ++bit ){
+        if( vs.km[ ii ] >> bit & 1 ){ key[ 64 * vs.kw[ ii ] + 2 * bit ] = 1; }
+      }
+    }
+    if( vs.kw.empty() && ti < nr_trans ){
+      for( unsigned var = 0; var < nr_vars; var += 2 ){ key[ var ] = 1; }
+    }
+    for( unsigned var = 0; var < nr_vars; var += 2 ){
+      if( key[ var ] ){ st.kv.push_back( var ); next[ var + 1 ] = 1; }
+      else{ nonkey[ var ] = 1; }
+    }
+    st.key_set = bdd_new_set( key ); st.nonkey_set = bdd_new_set( nonkey );
+    st.next_set = bdd_new_set( next ); st.rel = st.seen = 0;
+  }
+
+  /* Construct the breadth-first rings, checking the new states. */
+  bdd reach = sym_state( sym_init ), front = reach;
+  sym_rings.push_back( reach );
+  #ifndef no_show_cnt
+  const char *progress_msg = " states constructed\n\033[F";
+  #endif
+  while( front ){
+    #ifdef chk_state
+    #ifndef state_vars
+    if( !sym_check( front, false, sym_rings.size() - 1 ) ){ return; }
+    #else
+    {
+      sym_learn( nr_trans, front );
+      bdd bad = bdd_apply( op_and, front, sym_bad );
+      if( err_msg ){ report_error( 0, "Symbolic error" ); return; }
+      if( bad ){
+        std::vector< unsigned > words; sym_pick( bad, words );
+        state_row( 0, words, true ); use_state( 0 );
+        err_msg = model::check_state();
+        sym_report( sym_rings.size() - 1, words, "Safety error" ); return;
+      }
+    }
+    #endif
+    #endif
+    for( unsigned tr = 0; !err_msg && tr < nr_trans; ++tr ){
+      sym_learn( tr, front );
+    }
+    if( err_msg ){ report_error( 0, "Transition firing error" ); return; }
+    front = bdd_apply( op_diff, sym_step( front, false ), reach );
+    reach = bdd_apply( op_or, reach, front );
+    if( err_msg ){ report_error( 0, "Symbolic error" ); return; }
+    if( !front ){ break; }
+    sym_rings.push_back( front );
+    #ifndef no_show_cnt
+    std::cout << clean_eol; sym_print_count( sym_count( reach ) );
+    std::cout << progress_msg << std::flush;
+    #endif
+  }
+
+  /* Check the states where no transition is enabled, nearest first. */
+  #ifdef chk_deadlock
+  bdd en = 0;
+  for( unsigned tr = 0; tr < nr_trans; ++tr ){
+    en = bdd_apply(
+      op_or, en, bdd_and_exists( sym_trs[ tr ].rel, 1, sym_trs[ tr ].next_set )
+    );
+  }
+  for( unsigned ri = 0; !err_msg && ri < sym_rings.size(); ++ri ){
+    if( !sym_check( bdd_apply( op_diff, sym_rings[ ri ], en ), true, ri ) ){
+      return;
+    }
+  }
+  if( err_msg ){ report_error( 0, "Symbolic error" ); return; }
+  #endif
+
+  std::cout << clean_eol; sym_print_count( sym_count( reach ) );
+  std::cout << " states, " << sym_rings.size() << " levels, "
+    << bdd_nodes.size() << " BDD nodes\n";
+}
+#endif
+
+
+/* Estimation of the size of the state space */
+/* With estimate, the first estimate states are constructed in breadth-first
+  order, and the numbers of states on the complete levels are recorded. A
+  parabola is fitted to the logarithms of these numbers, that is, the level
+  sizes are assumed to follow a bell curve, and the levels are continued
+  along it until they become empty. Nothing guarantees that the levels
+  still to come follow the curve, so no bounds are given for the estimate.
+  The numbers of edges and the memory use with the current settings are derived from the
+  numbers of states. If all states fit in estimate, the numbers are exact. */
+#ifdef estimate
+/* Continues the levels after a level of log size yy along the parabola
+  yy + dy k + cc k^2 for k = 1, 2, ..., and returns the number of the states
+  on them, or a negative number if it is not bounded. dd gets the number of
+  the added levels. */
+double est_rest( double yy, double dy, double cc, unsigned &dd ){
+  double sum = 0; dd = 0;
+  if( cc >= 0 ){ return -1; }
+  for( double kk = 1; ; ++kk ){
+    double nn = std::exp( yy + dy * kk + cc * kk * kk );
+    if( nn < 0.5 && dy + 2 * cc * kk < 0 ){ return sum; }
+    sum += nn; ++dd;
+    if( sum > 1e30 ){ return -1; }
+  }
+}
+
+/* Returns the bytes that ASSET would use for nn states and ne edges. */
+double est_bytes( double nn, double ne ){
+  double per_state =
+    sizeof( unsigned ) * state_var::nr_words + 2 * sizeof( node_idx );
+  double per_edge = 0;
+  #ifndef no_progr_chk
+  per_state += 2 * sizeof( edge_idx ) + sizeof( node_idx ) + 1;
+  per_edge = sizeof( node_idx );
+  #ifdef packed_edges
+  per_edge = 2;
+  #endif
+  #ifdef edge_file
+  per_state -= sizeof( edge_idx ) + sizeof( node_idx ) - 1;
+  per_edge = 0;
+  #endif
+  #endif
+  return double( hash_size ) * sizeof( node_idx ) + per_state * nn +
+    per_edge * ne;
+}
+
+/* Prints a line of the results. */
+void est_line( const char *name, double val ){
+  std::cout << "  " << name << ' ' << (unsigned long long)( val + 0.5 )
+    << '\n';
+}
+
+/* Constructs the beginning of the state space and prints the estimates. */
+void estimate_state_space(){
+  std::vector< node_idx > lvl( 1, 1 );  // the first node of each level
+  node_idx lvl_end = 2;     // the end of the level being investigated
+  node_idx q_first = 1;
+  #ifndef no_show_cnt
+  const char *progress_msg = " states constructed\n\033[F";
+  #endif
+  for( ; q_first < nodes.size(); ++q_first ){
+    if( q_first == lvl_end ){
+      lvl.push_back( q_first ); lvl_end = nodes.size();
+    }
+    if( nodes.size() - 1 >= node_idx( estimate ) ){ break; }
+    #ifndef no_show_cnt
+    if( q_first % show_count == 0 ){
+      std::cout << q_first << progress_msg; std::cout.flush();
+    }
+    #endif
+    fire_init( q_first );
+    for( unsigned tr = 0; tr < nr_trans; ++tr ){
+      bool en = model::fire_transition( tr );
+      if( err_msg ){
+        report_error( q_first, "Transition firing error" ); return;
+      }
+      if( !en ){ continue; }
+      #ifdef symmetry
+      model::symmetry_representative();
+      #endif
+      node_idx n2 = hash_insert(); ++nr_edges;
+      if( err_msg ){ report_error( q_first, "Error" ); return; }
+      if( hash_was_new ){ nodes.prev[ n2 ] = q_first; }
+      fire_init( q_first );
+    }
+  }
+  std::cout << clean_eol;
+
+  /* The sizes of the complete levels 0, ..., ll */
+  unsigned ll = lvl.size() - 1;
+  std::vector< double > sz( ll + 1 );
+  for( unsigned li = 0; li < ll; ++li ){ sz[ li ] = lvl[ li+1 ] - lvl[ li ]; }
+  sz[ ll ] = lvl_end - lvl[ ll ];
+  double found = nodes.size() - 1, degree = double( nr_edges ) / q_first;
+  if( q_first > 1 ){ degree = double( nr_edges ) / ( q_first - 1 ); }
+
+  /* If the construction was completed, the numbers are exact. */
+  if( q_first == nodes.size() ){
+    std::cout << "The state space was constructed completely:\n";
+    est_line( "states", found );
+    est_line( "edges", nr_edges );
+    est_line( "depth", ll );
+    est_line( "MB", est_bytes( found, nr_edges ) / 1048576 );
+    return;
+  }
+
+  /* Fit a parabola c0 + c1 x + c2 x^2, where x = level - lbar, to the
+    logarithms of the sizes of the levels, by least squares. */
+  std::cout << "Estimate from " << nodes.size() - 1 << " states on " << ll + 1
+    << " complete levels:\n";
+  double mm = ll + 1, lbar = ll / 2., s2 = 0, s3 = 0, s4 = 0, t0 = 0, t1 = 0,
+    t2 = 0;
+  for( unsigned li = 0; li <= ll; ++li ){
+    double xx = li - lbar, yy = std::log( sz[ li ] );
+    s2 += xx * xx; s3 += xx * xx * xx; s4 += xx * xx * xx * xx;
+    t0 += yy; t1 += xx * yy; t2 += xx * xx * yy;
+  }
+  double det = mm * ( s2 * s4 - s3 * s3 ) - s2 * s2 * s2;
+  if( ll < 4 || det <= 0 ){
+    std::cout << "  too few levels to extrapolate, give a bigger estimate\n";
+    return;
+  }
+  double
+    c0 = ( t0 * ( s2 * s4 - s3 * s3 ) + s2 * ( t1 * s3 - t2 * s2 ) ) / det,
+    c1 = ( mm * ( t1 * s4 - s3 * t2 ) + s2 * ( s3 * t0 - s2 * t1 ) ) / det,
+    c2 = ( mm * ( s2 * t2 - s3 * t1 ) - s2 * s2 * t0 ) / det;
+
+  /* Continue the levels from the fitted value and slope at the last
+    complete level, with the fitted curvature. */
+  double xx = ll - lbar, yl = c0 + c1 * xx + c2 * xx * xx,
+    dl = c1 + 2 * c2 * xx;
+  unsigned dd = 0;
+  double rest = est_rest( yl, dl, c2, dd );
+  if( rest < 0 ){
+    std::cout << "  the levels are not yet getting smaller, so the size"
+      " cannot be estimated,\n  give a bigger estimate\n";
+    return;
+  }
+  double est = std::max( lvl_end - 1 + rest, found );
+  est_line( "states", est );
+  est_line( "edges", est * degree );
+  est_line( "depth", ll + dd );
+  est_line( "MB", est_bytes( est, est * degree ) / 1048576 );
+  std::cout << "  with hash_bits=" << hash_bits << ", "
+    << est / double( hash_size ) << " states per hash list\n";
+  if( dl > 0 ){
+    std::cout << "  the widest level is still ahead, so the estimates are"
+      " likely too small\n";
+  }
+}
+#endif
+
+
+/* Bidirectional search */
+/* With bidirectional, breadth-first search is made forward from the initial
+  state and backward from the goal states given by next_goal, one level at a
+  time on the side whose frontier is smaller. Both sides use the same nodes,
+  and side tells which side found each node. The finding predecessor of a
+  backward node is the node from which it was found, that is, its successor
+  towards the goal. When an edge from a forward node f to a backward node b
+  is found, the level is completed, and the shortest path via such an edge is
+  printed. (A new forward node that check_state rejects is a meeting with
+  b = 0.) The backward steps of the path are checked by firing the
+  transitions forward. Only check_state errors are searched for. */
+#ifdef bidirectional
+struct bidi_meet{
+  node_idx f, b; unsigned len;
+};
+
+/* Updates the best meeting found so far. */
+inline void bidi_note(
+  bidi_meet &best, node_idx ff, node_idx bb, unsigned len
+){
+  if( len < best.len ){ best.f = ff; best.b = bb; best.len = len; }
+}
+
+/* Tells whether some transition leads from node n1 to node n2. */
+bool bidi_edge( node_idx n1, node_idx n2 ){
+  for( unsigned tr = 0; tr < nr_trans; ++tr ){
+    fire_init( n1 );
+    if( model::fire_transition( tr ) && hash_find() == n2 ){ return true; }
+  }
+  return false;
+}
+
+/* Prints the path of the meeting and reports the error. */
+void bidi_report( const bidi_meet &best ){
+  std::cout << clean_eol; print_history( best.f );
+  node_idx n1 = best.f;
+  for( node_idx n2 = best.b; n2; n1 = n2, n2 = nodes.prev[ n2 ] ){
+    if( !bidi_edge( n1, n2 ) ){
+      err_msg = "fire_backward gave a state that is not a predecessor";
+      report_error( 0, "Backward firing error" ); return;
+    }
+    use_state( n2 ); model::print_state();
+  }
+  use_state( n1 ); err_msg = model::check_state();
+  report_error( 0, "Safety error" );
+}
+
+/* Searches for a shortest path from the initial state to a goal state. */
+void verify_bidirectional(){
+  std::vector< char > side( nodes.size(), 0 );  // 0 = forward, 1 = backward
+  std::vector< unsigned > depth( nodes.size(), 0 ); // level of the node
+  std::vector< node_idx > front[ 2 ], next;
+  node_idx side_cnt[ 2 ] = { 1, 0 };
+  bidi_meet best = { 0, 0, ~0u };
+  front[ 0 ].push_back( 1 );
+
+  /* Put the goal states to the backward frontier. */
+  for( unsigned gi = 0; ; ++gi ){
+    fire_init( 1 );
+    bool more = model::next_goal( gi );
+    if( err_msg ){ report_error( 0, "Goal error" ); return; }
+    if( !more ){ break; }
+    #ifndef no_sanity_chk
+    if( !model::check_state() ){
+      err_msg = "next_goal gave a state that check_state accepts";
+      model::print_state(); report_error( 0, "Goal error" ); return;
+    }
+    #endif
+    node_idx ni = hash_insert();
+    if( err_msg ){ report_error( 0, "Goal error" ); return; }
+    if( !hash_was_new ){ continue; }
+    side.push_back( 1 ); depth.push_back( 0 );
+    nodes.prev[ ni ] = 0; front[ 1 ].push_back( ni ); ++side_cnt[ 1 ];
+  }
+
+  /* Expand a level of the smaller frontier until the sides meet. */
+  #ifndef no_show_cnt
+  const char *progress_msg = " states constructed\n\033[F";
+  node_idx q_cnt = 0;
+  #endif
+  while( !front[ 0 ].empty() && !front[ 1 ].empty() && best.len == ~0u ){
+    bool sd = front[ 1 ].size() < front[ 0 ].size();
+    next.clear();
+    for( node_idx qi = 0; qi < front[ sd ].size(); ++qi ){
+      node_idx n1 = front[ sd ][ qi ];
+      #ifndef no_show_cnt
+      if( ++q_cnt % show_count == 0 ){
+        std::cout << nodes.size() - 1 << progress_msg; std::cout.flush();
       }
-      if( some_fired ){ break; }
       #endif
+      fire_init( n1 );
+      for( unsigned tr = 0; tr < nr_trans; ++tr ){
+        bool en =
+          sd ? model::fire_backward( tr ) : model::fire_transition( tr );
+        if( err_msg ){
+          report_error(
+            n1, sd ? "Backward firing error" : "Transition firing error"
+          ); return;
+        }
+        if( !en ){ continue; }
+        node_idx n2 = hash_insert(); ++nr_edges;
+        if( err_msg ){ report_error( n1, "Error" ); return; }
+        if( hash_was_new ){
+          side.push_back( sd ); depth.push_back( depth[ n1 ] + 1 );
+          nodes.prev[ n2 ] = n1; next.push_back( n2 ); ++side_cnt[ sd ];
+          if( !sd && model::check_state() ){
+            bidi_note( best, n2, 0, depth[ n2 ] );
+          }
+        }else if( side[ n2 ] != sd ){
+          if( sd ){ bidi_note( best, n2, n1, depth[ n2 ] + 1 + depth[ n1 ] ); }
+          else{ bidi_note( best, n1, n2, depth[ n1 ] + 1 + depth[ n2 ] ); }
+        }
+        fire_init( n1 );
+      }
+    }
+    front[ sd ].swap( next );
+  }
+
+  /* Report the shortest path, or that the goals are not reachable. */
+  std::cout << clean_eol;
+  if( best.len != ~0u ){ bidi_report( best ); }
+  else{ std::cout << "No goal state is reachable\n"; }
+  std::cout << side_cnt[ 0 ] << " forward and " << side_cnt[ 1 ]
+    << " backward states\n";
+}
+#endif
+
+
+/* Depth-first search with a bounded state cache */
+/* With dfs_cache, the states are searched depth-first, and instead of all
+  found states, only a cache of dfs_cache megabytes of them is kept. When the
+  cache is full, a state is evicted to make room for the new one: the least
+  recently used one, or a pseudo-random one with dfs_random. A state that is
+  found again after it was evicted is investigated again, so the time may
+  grow much beyond that of keeping all states. The states on the stack are
+  never evicted, so the search terminates. The stack consists of nodes 1, 2,
+  ..., top, each with the one below it as its finding predecessor, so that
+  print_history prints the stack as the counterexample. Safety and deadlock
+  errors are looked for. With stubborn, the enabled transitions of the
+  stubborn set of a state are found when the state is entered, and are fired
+  one at a time. If one of them leads to a state on the stack, all
+  transitions of the state are fired (the stack proviso), so that no
+  transition is ignored forever along a cycle. The cache has slots 1, ...,
+  dc_size, and 0 means none. */
+#ifdef dfs_cache
+node_idx dc_size = 0, dc_used = 0, dc_mask = 0;
+unsigned dc_words = 0;                // words per state
+std::vector< unsigned > dc_data;      // the states of the slots
+std::vector< node_idx > dc_bucket;    // the first slot of each hash list
+std::vector< node_idx > dc_next;      // the next slot in the hash list
+std::vector< char > dc_pinned;        // the state is on the stack
+#ifdef dfs_random
+unsigned long long dc_seed = 12345;   // for choosing the evicted slot
+#else
+std::vector< node_idx > dc_newer, dc_older;   // the LRU list of free slots
+node_idx dc_head = 0, dc_tail = 0;            // most and least recent
+#endif
+unsigned long long
+  dfs_entered = 0,      // pushes to the stack
+  dfs_evicted = 0,      // states evicted from the cache
+  dfs_depth = 0;        // maximum depth of the stack
+
+/* Divides the memory of dfs_cache megabytes to slots and hash lists. */
+void dc_setup(){
+  unsigned nw = dc_words = state_var::nr_words;
+  size_t per = nw * sizeof( unsigned ) + 2 * sizeof( node_idx ) + 1;
+  #ifndef dfs_random
+  per += 2 * sizeof( node_idx );
+  #endif
+  size_t nn = ( size_t( dfs_cache ) << 20 ) / per;
+  if( nn > size_t( ~node_idx( 0 ) - 1 ) ){ nn = ~node_idx( 0 ) - 1; }
+  if( nn < 2 ){ err_msg = "dfs_cache is too small"; return; }
+  dc_size = nn;
+  for( dc_mask = 1; dc_mask <= dc_size / 2; dc_mask <<= 1 ){}
+  dc_bucket.assign( dc_mask, 0 ); --dc_mask;
+  dc_data.resize( ( dc_size + 1 ) * nw ); dc_next.resize( dc_size + 1 );
+  dc_pinned.resize( dc_size + 1 );
+  #ifndef dfs_random
+  dc_newer.resize( dc_size + 1 ); dc_older.resize( dc_size + 1 );
+  #endif
+}
+
+/* Returns the hash list of the state st. */
+inline node_idx dc_hash( const unsigned *st ){
+  node_idx idx = 0;
+  for( unsigned ii = 0; ii < dc_words; ++ii ){
+    idx ^= st[ ii ]; idx *= 0x9e3779b1u; idx ^= idx >> 15;
+  }
+  return idx & dc_mask;
+}
 
+/* Returns the slot of state st in hash list bk, or 0 if it is not there. */
+node_idx dc_find( const unsigned *st, node_idx bk ){
+  unsigned nw = dc_words;
+  for( node_idx sl = dc_bucket[ bk ]; sl; sl = dc_next[ sl ] ){
+    if( !std::memcmp( &dc_data[ sl * nw ], st, nw * sizeof( unsigned ) ) ){
+      return sl;
     }
+  }
+  return 0;
+}
 
-    /* Check the state against deadlock errors. */
-    #ifndef no_progr_chk
-    if( !bss_second ){
-    #endif
-      if( old_edges == nr_edges ){
-        #ifdef chk_deadlock
-        use_state( q_first ); err_msg = model::check_deadlock();
-        if( err_msg ){ report_error( q_first, "Illegal deadlock" ); return; }
-        #endif
-      }
-    #ifndef no_progr_chk
-    }
-    #endif
+/* Takes slot sl out of and puts it back to the LRU list. */
+#ifndef dfs_random
+inline void dc_unlink( node_idx sl ){
+  node_idx nw = dc_newer[ sl ], od = dc_older[ sl ];
+  if( nw ){ dc_older[ nw ] = od; }else{ dc_head = od; }
+  if( od ){ dc_newer[ od ] = nw; }else{ dc_tail = nw; }
+}
+inline void dc_link( node_idx sl ){
+  dc_newer[ sl ] = 0; dc_older[ sl ] = dc_head;
+  if( dc_head ){ dc_newer[ dc_head ] = sl; }else{ dc_tail = sl; }
+  dc_head = sl;
+}
+#endif
 
+/* Returns a slot for a new state, evicting a state if the cache is full. */
+node_idx dc_victim(){
+  if( dc_used < dc_size ){ return ++dc_used; }
+  #ifdef dfs_random
+  dc_seed = dc_seed * 6364136223846793005ull + 1442695040888963407ull;
+  node_idx sl = ( dc_seed >> 24 ) % dc_size + 1;
+  for( node_idx ii = 0; dc_pinned[ sl ]; ++ii ){
+    if( ii == dc_size ){
+      err_msg = "The cache is too small for the depth of the search";
+      return 0;
+    }
+    sl = sl == dc_size ? 1 : sl + 1;
   }
-
-  /* Wipe out displayed running state count and clean up memory. */
-  std::cout << clean_eol;
-  #ifdef stubborn
-  delete [] stub_try; delete [] stub_found; delete [] stub_dfs;
-  delete [] stub_scc; delete [] stub_min;
+  #else
+  node_idx sl = dc_tail;
+  if( !sl ){
+    err_msg = "The cache is too small for the depth of the search"; return 0;
+  }
+  dc_unlink( sl );
   #endif
 
+  /* Remove the old state from its hash list. */
+  node_idx bk = dc_hash( &dc_data[ sl * dc_words ] );
+  node_idx *pp = &dc_bucket[ bk ];
+  while( *pp != sl ){ pp = &dc_next[ *pp ]; }
+  *pp = dc_next[ sl ]; ++dfs_evicted;
+  return sl;
 }
 
+/* Puts state st to the cache as being on the stack, and returns its slot. */
+node_idx dc_insert( const unsigned *st, node_idx bk ){
+  node_idx sl = dc_victim();
+  if( !sl ){ return 0; }
+  unsigned nw = dc_words;
+  std::memcpy( &dc_data[ sl * nw ], st, nw * sizeof( unsigned ) );
+  dc_next[ sl ] = dc_bucket[ bk ]; dc_bucket[ bk ] = sl;
+  dc_pinned[ sl ] = 1;
+  return sl;
+}
 
-/* Define dummy or real non-progress detection functions, as needed. */
-#ifdef no_progr_chk
-void construct_input_edges(){}
-void verify_progress( unsigned ){}
+/* Tells that the state of slot sl was left or used. */
+inline void dc_unpin( node_idx sl ){
+  dc_pinned[ sl ] = 0;
+  #ifndef dfs_random
+  dc_link( sl );
+  #endif
+}
+#ifdef dfs_random
+inline void dc_touch( node_idx ){}
 #else
+inline void dc_touch( node_idx sl ){
+  if( !dc_pinned[ sl ] ){ dc_unlink( sl ); dc_link( sl ); }
+}
+#endif
 
-/* Constructs a data structure for incoming edges of each node. */
-void construct_input_edges(){
-  iedges = new unsigned[ nr_edges ];
+/* Fires transition tr in the current state, which is a copy of node n1. */
+#ifdef no_sanity_chk
+inline bool dfs_fire( node_idx, unsigned tr ){
+#else
+inline bool dfs_fire( node_idx n1, unsigned tr ){
+#endif
+  #ifdef tr_cache
+  bool en = fire_cached< true >( tr );
+  #else
+  bool en = model::fire_transition( tr );
+  #endif
+  #ifndef no_sanity_chk
+  if( err_msg ){ report_error( n1, "Transition firing error" ); return false; }
+  #endif
+  #ifdef symmetry
+  if( en ){ model::symmetry_representative(); }
+  #endif
+  return en;
+}
 
-  /* Count the indices of incoming edges, using already computed counts. */
-  nodes[0].ie_end = nodes[1].ie_end = 0;
-  for( unsigned ni = 2; ni < nodes.size(); ++ni ){
-    nodes[ ni ].ie_end = nodes[ ni-1 ].ie_end + nodes[ ni-1 ].e_cnt;
+/* Collects the enabled transitions that stub_search gives in verify_dfs. */
+#ifdef stubborn
+struct dfs_collect{
+  node_idx n1; std::vector< unsigned > *list;
+  bool operator()( unsigned tr ){
+    bool en = dfs_fire( n1, tr );
+    if( en && !err_msg ){ list->push_back( tr ); fire_init( n1 ); }
+    return en;
   }
+};
+#endif
 
-  /* Re-generate the edges, putting them in iedges. */
-  bss_second = true; build_state_space(); return;
-
+/* Returns the transition that is tried ii'th when all are tried. */
+inline unsigned dfs_order( unsigned ii ){
+  #ifdef try_forward
+  return ii;
+  #else
+  return nr_trans - 1 - ii;
+  #endif
 }
 
-/* Finds non-progress errors. */
-void verify_progress( unsigned round ){
+/* Checks that node ni, which has no enabled transitions, may be terminal. */
+#ifdef chk_deadlock
+inline void dfs_deadlock( node_idx ni ){
+  use_state( ni ); err_msg = model::check_deadlock();
+  if( err_msg ){ report_error( ni, "Illegal deadlock" ); }
+}
+#else
+inline void dfs_deadlock( node_idx ){}
+#endif
 
-  /* Compute initial values of non-progress numbers depending on round. */
-  for( unsigned ni = 1; ni < nodes.size(); ++ni ){ nodes[ ni ].e_cnt = 0; }
-  if( round == 1 ){     // npn = the number of the output edges of the node.
-    for( unsigned ei = 0; ei < nr_edges; ++ei ){
-      ++nodes[ iedges[ ei ] ].e_cnt;
-    }
-  }else{                // npn = 0 if node has no output edges, otherwise 1.
-    for( unsigned ei = 0; ei < nr_edges; ++ei ){
-      nodes[ iedges[ ei ] ].e_cnt = 1;
-    }
-  }
+/* Searches the state space depth-first from the initial state. */
+void verify_dfs(){
+  dc_setup();
+  if( err_msg ){ report_error( 0, "Initialization error" ); return; }
+  unsigned nw = state_var::nr_words;
+  std::vector< node_idx > fr_slot( 2 );   // the cache slot of each node
+  std::vector< char > fr_en( 2 );         // some transition was enabled
+  #ifdef stubborn
+  std::vector< unsigned > fr_list;        // the transitions to fire
+  std::vector< size_t > fr_beg( 2 ), fr_pos( 2 );  // the list of each node
+  std::vector< char > fr_full( 2 ), tr_mark( nr_trans );
+  stub_alloc();
+  #else
+  std::vector< unsigned > fr_next( 2 );   // the next transition to try
+  #endif
+  #ifndef no_show_cnt
+  const char *progress_msg = " states entered\n\033[F";
+  #endif
 
-  /* Make npn:s 0 for progress states and 1 for non-progress deadlocks. */
-  if( round == 0 ){
-    for( unsigned ni = 1; ni < nodes.size(); ++ni ){
-      #ifdef dl_not_may
-      if( !nodes[ ni ].e_cnt ){ nodes[ ni ].e_cnt = 1; }
+  /* Each iteration first enters node top, if it is new, and then fires its
+    next transition, or leaves it if there are no more. */
+  node_idx top = 1;
+  const unsigned *init = &state_var::st_data[ nw ];
+  fr_slot[ 1 ] = dc_insert( init, dc_hash( init ) );
+  bool entering = true;
+  while( top ){
+    node_idx n1 = top;
+    if( entering ){
+      entering = false; ++dfs_entered;
+      if( top > dfs_depth ){ dfs_depth = top; }
+      #ifndef no_show_cnt
+      if( dfs_entered % show_count == 0 ){
+        std::cout << dfs_entered << progress_msg; std::cout.flush();
+      }
       #endif
-      if( nodes[ ni ].e_cnt ){
-        use_state( ni );
-        #ifdef chk_may_progress
-        if( model::is_may_progress() )
-        #endif
-          { nodes[ ni ].e_cnt = 0; }
-        if( err_msg ){
-          report_error( ni, "may_progress modelling error" ); return;
-        }
+      #ifdef stubborn
+      fr_beg[ n1 ] = fr_pos[ n1 ] = fr_list.size(); fr_full[ n1 ] = 0;
+      dfs_collect coll = { n1, &fr_list };
+      stub_fresh(); fire_init( n1 );
+      #ifdef try_forward
+      for( unsigned tr = 0; tr < nr_trans; ++tr ){
+      #else
+      for( unsigned tr = nr_trans; tr--; ){
+      #endif
+        if( stub_found[ tr ] == stub_nr ){ continue; }
+        bool some_fired = stub_search( n1, tr, coll );
+        if( err_msg ){ return; }
+        if( some_fired ){ break; }
       }
+      if( fr_list.size() == fr_beg[ n1 ] ){
+        dfs_deadlock( n1 ); if( err_msg ){ return; }
+      }
+      #else
+      fr_next[ n1 ] = 0; fr_en[ n1 ] = 0;
+      #endif
     }
-  }else if( round == 1 ){
-    for( unsigned ni = 1; ni < nodes.size(); ++ni ){
-      #ifdef dl_not_must
-      if( !nodes[ ni ].e_cnt ){ nodes[ ni ].e_cnt = 1; }
+
+    /* Choose the next transition, or leave the node. */
+    #ifdef stubborn
+    bool last = fr_pos[ n1 ] == fr_list.size();
+    #else
+    bool last = fr_next[ n1 ] == nr_trans;
+    if( last && !fr_en[ n1 ] ){ dfs_deadlock( n1 ); if( err_msg ){ return; } }
+    #endif
+    if( last ){
+      dc_unpin( fr_slot[ n1 ] ); --top; nodes.resize( top + 1 );
+      #ifdef stubborn
+      fr_list.resize( fr_beg[ n1 ] );
       #endif
-      if( nodes[ ni ].e_cnt ){
-        use_state( ni );
-        #ifdef chk_must_progress
-        if( model::is_must_progress() )
-        #endif
-          { nodes[ ni ].e_cnt = 0; }
-        if( err_msg ){
-          report_error( ni, "must_progress modelling error" ); return;
-        }
-      }
+      continue;
     }
-  }
+    #ifdef stubborn
+    unsigned tr = fr_list[ fr_pos[ n1 ]++ ];
+    #else
+    unsigned tr = dfs_order( fr_next[ n1 ]++ );
+    #endif
 
-  /* Backwards-propagate the information that a node with npn = 0 is reachable
-    via all / at least one output edge. */
-  unsigned p_list = 0;
-  for( unsigned ni = 1; ni < nodes.size(); ++ni ){
-    if( !nodes[ ni ].e_cnt ){ nodes[ ni ].p_next = p_list; p_list = ni; }
-  }
-  for( ; p_list; p_list = nodes[ p_list ].p_next ){
-    for( unsigned
-      ei = nodes[ p_list-1 ].ie_end; ei < nodes[ p_list ].ie_end; ++ei
-    ){
-      unsigned ni = iedges[ ei ];
-      if( nodes[ ni ].e_cnt ){
-        --nodes[ ni ].e_cnt;
-        if( !nodes[ ni ].e_cnt ){
-          nodes[ ni ].p_next = nodes[ p_list ].p_next;
-          nodes[ p_list ].p_next = ni;
+    /* Fire it, and find the resulting state from the cache. */
+    fire_init( n1 );
+    bool en = dfs_fire( n1, tr );
+    if( err_msg ){ return; }
+    if( !en ){ continue; }
+    fr_en[ n1 ] = 1; ++nr_edges;
+    const unsigned *st = &state_var::st_data[ nodes.size() * nw ];
+    node_idx bk = dc_hash( st ), sl = dc_find( st, bk );
+    if( sl ){
+      #ifdef stubborn
+      if( dc_pinned[ sl ] && !fr_full[ n1 ] ){
+        fr_full[ n1 ] = 1;
+        for( size_t ii = fr_beg[ n1 ]; ii < fr_list.size(); ++ii ){
+          tr_mark[ fr_list[ ii ] ] = 1;
+        }
+        for( unsigned ii = 0; ii < nr_trans; ++ii ){
+          unsigned t2 = dfs_order( ii );
+          if( !tr_mark[ t2 ] ){ fr_list.push_back( t2 ); }
+        }
+        for( size_t ii = fr_beg[ n1 ]; ii < fr_list.size(); ++ii ){
+          tr_mark[ fr_list[ ii ] ] = 0;
         }
       }
+      #endif
+      dc_touch( sl ); continue;
     }
-  }
-
-  /* Find and report a non-progress error, if exists. */
-  for( unsigned ni = 1; ni < nodes.size(); ++ni ){
-    if( nodes[ ni ].e_cnt ){
-
-      /* Print history up to entering the state that violates progress. */
-      std::cout << clean_eol; print_history( nodes[ ni ].prev );
-      std::cout << "==========\n";
-
-      /* Print a typical sequence of events starting at the error node. */
-      print_typical( ni, true );
-
-      /* Report the error. */
-      err_msg = "";
-      if( round == 0 ){
-        report_error( 0, "May-type non-progress error" ); return;
-      }else if( round == 1 ){
-        report_error( 0, "Must-type non-progress error" ); return;
-      }else if( round == 2 ){
-        report_error(
-          0, "State was reached from which termination is unreachable"
-        );
-        return;
-      }
 
+    /* Push the new or evicted state to the stack and check it. */
+    sl = dc_insert( st, bk );
+    if( err_msg ){ report_error( n1, "State cache error" ); return; }
+    node_idx n2 = ++top;
+    nodes.resize( n2 + 1 ); nodes.prev[ n2 ] = n1;
+    if( state_var::st_data.size() < ( n2 + 2 ) * nw ){
+      state_var::st_data.resize( ( n2 + 2 ) * nw );
     }
-  }
+    if( fr_slot.size() <= n2 ){
+      fr_slot.resize( 2 * n2 ); fr_en.resize( 2 * n2 );
+      #ifdef stubborn
+      fr_beg.resize( 2 * n2 ); fr_pos.resize( 2 * n2 );
+      fr_full.resize( 2 * n2 );
+      #else
+      fr_next.resize( 2 * n2 );
+      #endif
+    }
+    fr_slot[ n2 ] = sl; entering = true;
+    #ifdef chk_state
+    use_state( n2 ); err_msg = model::check_state();
+    if( err_msg ){ report_error( n2, "Safety error" ); return; }
+    #endif
 
+  }
+  std::cout << clean_eol;
+  #ifdef stubborn
+  stub_free();
+  #endif
 }
 #endif
 
@@ -876,16 +5903,49 @@ int main(){
   #ifndef chk_deadlock
   #ifndef chk_must_progress
   #ifndef chk_may_progress
+  #ifndef chk_props
   err_msg = "No error detection function \"My_...\" defined";
   report_error( 0, "Will not start model checking" ); return 0;
   #endif
   #endif
   #endif
   #endif
+  #endif
+  #ifdef load_file
+  #ifdef lts_out
+  err_msg = "lts_file and aut_file cannot be used with load_file";
+  report_error( 0, "Will not start model checking" ); return 0;
+  #endif
+  #endif
+  #ifdef components
+  #ifdef chk_state
+  err_msg = "chk_state is not supported with components";
+  report_error( 0, "Will not start model checking" ); return 0;
+  #endif
+  #ifdef chk_props
+  err_msg = "chk_props is not supported with components";
+  report_error( 0, "Will not start model checking" ); return 0;
+  #endif
+  #endif
+
+  /* Size the data structures according to the memory budget. */
+  #ifdef mem_budget
+  budget_configure();
+  #endif
 
   /* Initialize the model. */
   store_initial_state();
   if( err_msg ){ report_error( 0, "Initialization error" ); return 0; }
+  #ifdef tr_cache
+  cache_setup();
+  if( err_msg ){ report_error( 0, "Initialization error" ); return 0; }
+  #endif
+  #ifdef stop_between
+  if( stop_count <= nr_trans ){
+    err_msg = "stop_cnt must be bigger than the number of transitions";
+    report_error( 0, "Will not start model checking" ); return 0;
+  }
+  #endif
 
   #ifdef only_typical
 
@@ -896,38 +5956,242 @@ int main(){
 
   #else
 
+  #ifdef components
+
+  /* Verify the model component by component. */
+  verify_components();
+
+  #else
+  #ifdef estimate
+
+  /* Estimate the size of the state space. */
+  estimate_state_space();
+
+  #else
+  #ifdef symbolic
+
+  /* Verify the model symbolically. */
+  verify_symbolic();
+
+  #else
+  #ifdef bidirectional
+
+  /* Search for a goal state from both ends. */
+  verify_bidirectional();
+
+  #else
+  #ifdef dfs_cache
+
+  /* Search depth-first, keeping only a cache of the states. */
+  verify_dfs();
+
+  #else
+
+  /* Continue from a saved state space, if requested. */
+  #ifdef load_file
+  load_state_space();
+  if( err_msg ){ report_error( 0, "Load error" ); return 0; }
+  #endif
+
   /* Do the requested model checking tasks. */
+  #ifdef lts_input
+  lts_read( false );
+  #else
+  #ifdef lts_out
+  lts_open();
+  if( err_msg ){ report_error( 0, "Export error" ); return 0; }
+  #endif
+  #ifdef telemetry
+  tel_start();
+  #endif
   build_state_space();
+  #ifdef telemetry
+  tel_finish();
+  #endif
+  #ifdef lts_out
+  lts_close();
+  #endif
+  #endif
+  #ifndef no_progr_chk
+  #ifdef mem_budget
+  if( !err_msg && !iedges ){ budget_next = 0; budget_check(); }
+  if( iedges ){ budget_no_progr = false; }
+  #endif
+  if( !err_msg && !iedges ){ construct_input_edges(); }
+  #ifdef stats_file
+  if( !err_msg && iedges ){ write_stats(); }
+  #endif
+  #ifdef minimize
+  if( !err_msg && iedges ){ minimize_state_space(); }
+  #endif
+  #else
   if( !err_msg ){ construct_input_edges(); }
+  #endif
+  #ifdef save_file
+  if( !err_msg || bss_stopped ){
+    const char *msg = err_msg; err_msg = 0; save_state_space();
+    if( err_msg ){ report_error( 0, "Save error" ); return 0; }
+    err_msg = msg;
+  }
+  #endif
+  #ifdef chk_props
+  for( unsigned pi = 0; pi < props.size(); ++pi ){
+    if( props[ pi ].node ){ report_prop( props[ pi ] ); }
+  }
+  #endif
+  if( !err_msg ){ fused_progress(); }
   #ifdef chk_may_progress
-  if( !err_msg ){ verify_progress(0); }
+  if( !err_msg ){ fused_report( 0 ); }
   #endif
   #ifdef chk_must_progress
-  if( !err_msg ){ verify_progress(1); }
+  if( !err_msg ){ fused_report( 1 ); }
+  #endif
+  #ifdef chk_props
+  for( unsigned pi = 0; !err_msg && pi < props.size(); ++pi ){
+    prop_type &pr = props[ pi ];
+    if( pr.kind == prop_may_pr ){ verify_progress( 0, pr.is_progress, &pr ); }
+    else if( pr.kind == prop_must_pr ){
+      verify_progress( 1, pr.is_progress, &pr );
+    }
+  }
+  #endif
+  #ifdef stubborn
+  if( !err_msg ){ fused_report( 2 ); }
+  #endif
+  #ifndef no_progr_chk
+  #ifdef edge_file
+  ie_close();
+  #endif
+  delete [] iedges; iedges = 0;
+  free_column( nodes.ie_end ); free_column( nodes.p_next );
+  free_column( p_flags );
+  #ifdef tr_labels
+  delete [] ie_tr; ie_tr = 0;
+  #endif
+  #ifdef minimize
+  free_column( q_label ); free_column( q_ie_end ); free_column( q_iedges );
+  #endif
   #endif
   #ifdef stubborn
-  if( !err_msg ){ verify_progress(2); }
   #ifdef chk_must_progress
   if( !err_msg ){
     err_msg = "Must progress is unreliable with stubborn sets";
   }
   #endif
+  #ifdef chk_props
+  for( unsigned pi = 0; !err_msg && pi < props.size(); ++pi ){
+    if( props[ pi ].kind == prop_must_pr ){
+      err_msg = "Must progress is unreliable with stubborn sets";
+    }
+  }
+  #endif
+  #endif
+
+  #endif
+  #endif
+  #endif
+  #endif
   #endif
 
   #ifndef chk_deadlock
   #ifndef chk_must_progress
   #ifndef chk_may_progress
+  #ifndef chk_props
   if( !err_msg ){
     err_msg = "Nothing was defined to test that the model makes progress";
   }
   #endif
   #endif
   #endif
+  #endif
 
   /* Print the results. */
+  #ifndef components
+  #ifndef symbolic
+  #ifndef estimate
+  #ifdef dfs_cache
+  std::cout << dfs_entered << " states entered, " << nr_edges << " edges\n"
+    << "State cache: " << dc_used << " of " << dc_size << " slots used, "
+    << dfs_evicted << " evictions, maximum depth " << dfs_depth << '\n';
+  #else
   std::cout << nodes.size()-1 << " states, " << nr_edges << " edges\n";
+  #endif
+  #endif
+  #endif
+  #endif
+  #ifdef minimize
+  if( nr_blocks ){ std::cout << nr_blocks << " states after minimization\n"; }
+  #endif
+  #ifdef tr_cache
+  std::cout << "Transition cache: " << cache_hits << " hits, "
+    << cache_misses << " misses\n";
+  #endif
+  #ifdef profile
+  prof_report();
+  #endif
+  #ifdef chk_props
+  #ifndef components
+  #ifndef symbolic
+  #ifndef estimate
+  unsigned nr_violated = 0;
+  for( unsigned pi = 0; pi < props.size(); ++pi ){
+    if( props[ pi ].node ){ ++nr_violated; }
+  }
+  std::cout << props.size() << " properties, " << nr_violated
+    << " violated\n";
+  #endif
+  #endif
+  #endif
+  #endif
   if( err_msg ){ report_error( 0, "Error" ); }
 
+  /* Tell whether beam search dropped states. */
+  #ifdef beam_width
+  if( dir_dropped && !err_msg ){
+    std::cout << "Note: beam search dropped " << dir_dropped
+      << " states, so errors may have been missed\n";
+  }
+  #endif
+
+  /* Tell which guarantees remain, if the memory budget did not suffice. If
+    checks were dropped or states may have been missed, the exit status
+    tells it, too. */
+  #ifdef mem_budget
+  bool budget_lost = false;
+  if( bss_stopped ){
+    std::cout << "!!! Warning: construction was stopped, so only safety and"
+      " deadlock were checked, and only in the constructed states\n";
+    budget_lost = true;
+  }else if( budget_no_progr ){
+    #ifndef stats_only
+    std::cout << "!!! Warning: progress was not checked, because it would not"
+      " fit in the memory budget\n";
+    budget_lost = true;
+    #endif
+    #ifdef stats_file
+    std::cout << "Note: stats_file was not written, because the incoming"
+      " edges would not fit in the memory budget\n";
+    #endif
+  }
+  #ifdef stubborn
+  #ifndef stats_only
+  if( budget_no_progr ){
+    std::cout << "!!! Warning: without the termination check, stubborn sets"
+      " do not guarantee that all safety errors were found\n";
+    budget_lost = true;
+  }
+  #endif
+  #endif
+  #ifdef budget_shrink
+  if( hc_base > 2 ){
+    std::cout << "!!! Warning: " << hc_base - 2 << " states were kept only as"
+      " signatures (hash compaction), so parts of the state space may have"
+      " been missed\n";
+    budget_lost = true;
+  }
+  #endif
+  #endif
+
   /* Print the most important analysis settings. */
   #ifdef no_show_cnt
   std::cout << "Settings:";
@@ -952,6 +6216,9 @@ int main(){
   std::cout << "!dl";
   #endif
   #endif
+  #ifdef chk_props
+  std::cout << " props";
+  #endif
   #ifdef stubborn
   std::cout << " stubb";
   #endif
@@ -961,12 +6228,79 @@ int main(){
   #ifdef try_forward
   std::cout << " forw";
   #endif
+  #ifdef best_first
+  std::cout << " best";
+  #endif
+  #ifdef a_star
+  std::cout << " astar";
+  #endif
+  #ifdef beam_width
+  std::cout << " beam=" << beam_width;
+  #endif
   #ifdef no_sanity_chk
   std::cout << " no_s_s";
   #endif
+  #ifdef profile
+  std::cout << " prof";
+  #endif
+  #ifdef warm_up
+  std::cout << " warm=" << warm_up;
+  #ifdef warm_sample
+  std::cout << "/" << warm_sample;
+  #endif
+  #endif
+  #ifdef wide_idx
+  std::cout << " wide";
+  #endif
+  #ifdef lts_out
+  std::cout << " export";
+  #endif
+  #ifdef lts_input
+  std::cout << " import";
+  #endif
+  #ifdef minimize
+  std::cout << " min";
+  #endif
+  #ifdef packed_edges
+  std::cout << " packed";
+  #endif
+  #ifdef edge_file
+  std::cout << " edge_file";
+  #endif
+  #ifdef components
+  std::cout << " comp";
+  #endif
+  #ifdef tr_cache
+  std::cout << " cache=" << cache_bits;
+  #endif
+  #ifdef symbolic
+  std::cout << " symb";
+  #endif
+  #ifdef estimate
+  std::cout << " estimate=" << estimate;
+  #endif
+  #ifdef stats_file
+  std::cout << " stats";
+  #endif
+  #ifdef dfs_cache
+  std::cout << " dfs=" << dfs_cache << 'M';
+  #ifdef dfs_random
+  std::cout << "/rand";
+  #endif
+  #endif
+  #ifdef bidirectional
+  std::cout << " bidi";
+  #endif
+  #ifdef mem_budget
+  std::cout << " budget=" << mem_budget << 'M';
+  #endif
   std::cout << " hash_bits=" << hash_bits << '\n';
   #endif
 
+  #ifdef mem_budget
+  if( budget_lost ){ return 1; }
+  #endif
+
   #endif
 
 }
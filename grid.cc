@@ -0,0 +1,60 @@
+/* A walk on a 64 x 64 grid with walls. The walker starts at the corner
+( 0, 0 ) and wants to reach ( 40, 40 ). It can step right, up, left, and down.
+There is a wall right of every column x with x % 8 == 7, with gaps at the rows
+y with y % 9 == 0. Stepping down is impossible onto a row y with y % 5 == 4.
+The shortest walk has 80 steps.
+
+Try this with and without the option bidirectional, and also with best_first
+and a_star.
+*/
+
+state_var x(6), y(6);
+
+void print_state(){ std::cout << "( " << x << ", " << y << " )\n"; }
+
+#define chk_state
+const char *check_state(){
+  if( x == 40 && y == 40 ){ return "The goal was reached"; }
+  return 0;
+}
+
+/* The remaining number of steps, if there were no walls */
+#define heuristic
+unsigned distance(){
+  return ( x < 40 ? 40 - x : x - 40 ) + ( y < 40 ? 40 - y : y - 40 );
+}
+
+bool wall_right( unsigned xx, unsigned yy ){
+  return xx % 8 == 7 && yy % 9 != 0;
+}
+
+unsigned nr_transitions(){ return 4; }
+bool fire_transition( unsigned tr ){
+  switch( tr ){
+  case 0: if( x < 63 && !wall_right( x, y ) ){ ++x; return true; }return false;
+  case 1: if( y < 63 ){ ++y; return true; }return false;
+  case 2: if( x > 0 && !wall_right( x - 1, y ) ){ --x; return true; }
+    return false;
+  case 3: if( y > 0 && y % 5 != 0 ){ --y; return true; }return false;
+  }
+  return false;
+}
+
+/* For bidirectional: the transitions backwards, and the goal state. Each
+backward step undoes the forward step of the same number, so it tests the
+condition of the forward step in the state that it produces. */
+#define backward
+bool fire_backward( unsigned tr ){
+  switch( tr ){
+  case 0: if( x > 0 && !wall_right( x - 1, y ) ){ --x; return true; }
+    return false;
+  case 1: if( y > 0 ){ --y; return true; }return false;
+  case 2: if( x < 63 && !wall_right( x, y ) ){ ++x; return true; }return false;
+  case 3: if( y < 63 && y % 5 != 4 ){ ++y; return true; }return false;
+  }
+  return false;
+}
+bool next_goal( unsigned gi ){
+  if( gi ){ return false; }
+  x = 40; y = 40; return true;
+}
@@ -0,0 +1,119 @@
+/* A pipeline of k stages. Stage 0 produces items, each stage processes its
+item in p internal steps and then hands it over to the next stage, and the
+last stage delivers it. A stage holds at most one item. The delivery is
+progress.
+  The model can be checked as a whole, or with the option components, in
+which each stage is a component. With k = 6 and p = 6, the whole state
+space has 8^6 = 262144 states, while no composition step of the components
+has more than a few dozen. Try also size_par, and jam, which lets the middle
+stage get stuck with its item. Then the whole pipeline eventually stops. */
+
+//#define jam         // the middle stage may get stuck
+
+#ifdef size_par
+const unsigned k = size_par;  // number of stages
+#else
+const unsigned k = 6;
+#endif
+const unsigned p = 6;         // number of processing steps per item
+
+state_array< k, 1 > full;     // the stage has an item
+state_array< k, 3 > step;     // processing steps done, p + 1 = stuck
+
+/* Prints the stages from the first to the last: . = empty, a digit = the
+  number of steps done, X = stuck. */
+void print_state(){
+  for( unsigned i = 0; i < k; ++i ){
+    if( !full[i] ){ std::cout << '.'; }
+    else if( step[i] > p ){ std::cout << 'X'; }
+    else{ std::cout << step[i]; }
+  }
+  std::cout << '\n';
+}
+
+
+/* The local moves of stage i */
+inline bool ready( unsigned i ){ return full[i] && step[i] == p; }
+inline bool get( unsigned i ){
+  if( full[i] ){ return false; }
+  full[i] = 1; step[i] = 0; return true;
+}
+inline bool work( unsigned i ){
+  if( !full[i] || step[i] >= p ){ return false; }
+  step[i] = step[i] + 1; return true;
+}
+inline bool put( unsigned i ){
+  if( !ready(i) ){ return false; }
+  full[i] = 0; step[i] = 0; return true;
+}
+#ifdef jam
+inline bool stick( unsigned i ){
+  if( i != k/2 || !full[i] || step[i] >= p ){ return false; }
+  step[i] = p + 1; return true;
+}
+#else
+inline bool stick( unsigned ){ return false; }
+#endif
+
+
+/* The model as a whole. Transition i < k moves an item into stage i, that
+  is, produces it if i = 0 and hands it over from stage i-1 otherwise.
+  Transition k + i is a step of stage i, 2k delivers, and 2k + 1 jams. */
+unsigned nr_transitions(){ return 2*k + 2; }
+bool fire_transition( unsigned tr ){
+  if( tr == 0 ){ return get(0); }
+  if( tr < k ){
+    if( full[tr] || !ready( tr-1 ) ){ return false; }
+    put( tr-1 ); get( tr ); return true;
+  }
+  if( tr < 2*k ){ return work( tr-k ); }
+  if( tr == 2*k ){ return put( k-1 ); }
+  return stick( k/2 );
+}
+
+#define chk_deadlock
+const char *check_deadlock(){ return "The pipeline stopped"; }
+
+#define chk_may_progress
+bool is_may_progress(){ return ready( k-1 ); }
+
+#define chk_must_progress
+bool is_must_progress(){ return ready( k-1 ); }
+
+
+/* The model as components. Action i with 1 <= i < k hands an item over
+  from stage i-1 to stage i, and action k is the delivery. The local
+  transitions of stage i are get, work, put, and jam. Getting is internal
+  in stage 0, and the other steps are internal in every stage. */
+#ifdef components
+unsigned nr_components(){ return k; }
+unsigned nr_actions(){ return k + 1; }
+
+bool uses_action( unsigned cp, unsigned act ){
+  return act == cp + 1 || ( cp && act == cp );
+}
+
+unsigned nr_local( unsigned ){ return 4; }
+
+bool fire_local( unsigned cp, unsigned tr, unsigned &act ){
+  act = 0;
+  switch( tr ){
+  case 0: act = cp; return get( cp );
+  case 1: return work( cp );
+  case 2: act = cp + 1; return put( cp );
+  }
+  return stick( cp );
+}
+
+/* The pipeline is never meant to stop, so a stage may only terminate
+  when it is empty. */
+bool local_final( unsigned cp ){ return !full[ cp ]; }
+
+void print_action( unsigned act ){
+  if( act < k ){ std::cout << "hand over to stage " << act << '\n'; }
+  else{ std::cout << "deliver\n"; }
+}
+
+inline bool is_may_action( unsigned act ){ return act == k; }
+inline bool is_must_action( unsigned act ){ return act == k; }
+#endif
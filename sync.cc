@@ -21,7 +21,8 @@ messages.
 
 
 #define terminate     // makes Sender capable of stopping for good
-//#define compress      // channels work atomically (not as a chain of cells)
+//#define compress      // channels are atomic (built-in channel type)
+//#define d_bits 32     // message size of atomic Data Channel, 3 ... 32
 //#define check_out   // check the delivered messages (makes more states)
 
 #ifdef size_par
@@ -40,9 +41,51 @@ state_var               // Sm and Rm have: 0=N 1=Y
   Cc(2),                // most recently sent message content 0=none 1=N 2=Y
   CN(1), CY(1),         // because of failures, N and/or Y may be remnant
   Sc(3), Sm(1), Sb(1),  // Sender control, message and alteranting bit
-  Rc(2), Rm(1), Rb(1),  // Receiver control, message and alteranting bit
-  Dc[n] = 2, Db[n] = 1, // Data channel cont. 0=none 1=N 2=Y 3=F and alt. bit
-  Ac[n] = 1, Ab[n] = 1; // Ack channel content and alternating bit
+  Rc(2), Rm(1), Rb(1);  // Receiver control, message and alteranting bit
+
+/* The channels are accessed via dc(i), db(i), ac(i), and ab(i) that give the
+  content and alternating bit of the message in cell i (0 = front), and via
+  d_send, d_rec, a_send, and a_rec that operate on the ends. d_empty and
+  a_empty tell whether a channel is empty. */
+#ifdef compress
+#ifndef d_bits
+#define d_bits 3
+#endif
+channel
+  D( n, d_bits ),       // Data channel messages: content * 2 + alt. bit
+  A( n, 1 );            // Ack channel messages: alternating bit
+inline unsigned dc( unsigned i ){ return i < D.length() ? D[i] >> 1 : 0; }
+inline unsigned db( unsigned i ){ return i < D.length() ? D[i] & 1 : 0; }
+inline unsigned ac( unsigned i ){ return i < A.length(); }
+inline unsigned ab( unsigned i ){ return i < A.length() ? A[i] : 0; }
+inline bool d_send( unsigned c, unsigned b ){ return D.send( c << 1 | b ); }
+inline void d_rec(){ D.receive(); }
+inline bool a_send( unsigned b ){ return A.send( b ); }
+inline void a_rec(){ A.receive(); }
+inline bool d_empty(){ return D.empty(); }
+inline bool a_empty(){ return A.empty(); }
+#else
+state_array< n, 2 > Dc; // Data channel content 0=none 1=N 2=Y 3=F
+state_array< n, 1 > Db; // Data channel alternating bit
+state_array< n, 1 > Ac; // Ack channel content
+state_array< n, 1 > Ab; // Ack channel alternating bit
+inline unsigned dc( unsigned i ){ return Dc[i]; }
+inline unsigned db( unsigned i ){ return Db[i]; }
+inline unsigned ac( unsigned i ){ return Ac[i]; }
+inline unsigned ab( unsigned i ){ return Ab[i]; }
+inline bool d_send( unsigned c, unsigned b ){
+  if( Dc[n-1] ){ return false; }
+  Dc[n-1] = c; Db[n-1] = b; return true;
+}
+inline void d_rec(){ Dc[0] = 0; Db[0] = 0; }
+inline bool a_send( unsigned b ){
+  if( Ac[n-1] ){ return false; }
+  Ac[n-1] = 1; Ab[n-1] = b; return true;
+}
+inline void a_rec(){ Ac[0] = 0; Ab[0] = 0; }
+inline bool d_empty(){ return Dc.is_zero() && Db.is_zero(); }
+inline bool a_empty(){ return Ac.is_zero() && Ab.is_zero(); }
+#endif
 
 const char mch[] = { ' ', 'N', 'Y', 'F' };
 
@@ -52,12 +95,12 @@ void print_state(){
   if( CY ){ std::cout << 'Y'; }else{ std::cout << ' '; }
   std::cout << ' ' << Sc << Sb << mch[ Sc && Sc < 4 ? Sm+1 : 0 ] << ' ';
   for( unsigned i = n; i--; ){
-    if( Dc[i] ){ std::cout << mch[ Dc[i] ] << Db[i]; }
+    if( dc(i) ){ std::cout << mch[ dc(i) ] << db(i); }
     else{ std::cout << "  "; }
   }
   std::cout << ' ' << Rc << Rb << mch[ Rc == 1 ? Rm+1 : 0 ] << ' ';
   for( unsigned i = n; i--; ){
-    if( Ac[i] ){ std::cout << Ab[i]; }
+    if( ac(i) ){ std::cout << ab(i); }
     else{ std::cout << " "; }
   }
   std::cout << '\n';
@@ -79,8 +122,7 @@ inline const char *check_state(){
 #define chk_deadlock
 inline const char *check_deadlock(){
   if(
-    Sc == 7 && !Sm && !Rc && !Rm &&
-    !Dc[0] && !Db[0] && !Ac[0] && !Ab[0] && !Cc
+    Sc == 7 && !Sm && !Rc && !Rm && d_empty() && a_empty() && !Cc
   ){ return 0; }
   return "Unexpected termination";
 }
@@ -99,26 +141,6 @@ inline bool is_must_progress(){
   return !Sc;
 }
 
-void cmprD(){
-  #ifdef compress
-  unsigned j = 0;
-  while( j < n && Dc[j] ){ ++j; }
-  for( unsigned i = j+1; i < n; ++i ){
-    if( Dc[i] ){ Dc[j] = Dc[i]; Dc[i] = 0; Db[j] = Db[i]; Db[i] = 0; ++j; }
-  }
-  #endif
-}
-
-void cmprA(){
-  #ifdef compress
-  unsigned j = 0;
-  while( j < n && Ac[j] ){ ++j; }
-  for( unsigned i = j+1; i < n; ++i ){
-    if( Ac[i] ){ Ac[j] = Ac[i]; Ac[i] = 0; Ab[j] = Ab[i]; Ab[i] = 0; ++j; }
-  }
-  #endif
-}
-
 unsigned nr_transitions(){
   unsigned nr_tr = 2*n + 3;
   std::cout << "ch-capacity = " << n;
@@ -149,19 +171,19 @@ bool fire_transition( unsigned tr ){
       #endif
       Sm = 0; Sc = 1; return true;
     case 1:   // flush!b
-      if( Dc[n-1] ){ return false; }
-      Dc[n-1] = 3; Db[n-1] = Sb; cmprD(); Sc = 2; return true;
+      if( !d_send( 3, Sb ) ){ return false; }
+      Sc = 2; return true;
     case 2:   // ack?b'  (if b == b' then swap b; goto 3)
-      if( !Ac[0] ){ return false; }
-      if( Sb == Ab[0] ){ Sb = !Sb; Sc = 3; }
-      Ac[0] = 0; Ab[0] = 0; cmprA(); return true;
+      if( !ac(0) ){ return false; }
+      if( Sb == ab(0) ){ Sb = !Sb; Sc = 3; }
+      a_rec(); return true;
     case 3:   // data!m!b
-      if( Dc[n-1] ){ return false; }
-      Dc[n-1] = Sm+1; Db[n-1] = Sb; cmprD(); Sc = 4; Sm = 0; return true;
+      if( !d_send( Sm+1, Sb ) ){ return false; }
+      Sc = 4; Sm = 0; return true;
     case 4:   // ack?b'  (if b == b' then swap b; goto 5)
-      if( !Ac[0] ){ return false; }
-      if( Sb == Ab[0] ){ Sb = !Sb; Sc = 5; }
-      Ac[0] = 0; Ab[0] = 0; cmprA(); return true;
+      if( !ac(0) ){ return false; }
+      if( Sb == ab(0) ){ Sb = !Sb; Sc = 5; }
+      a_rec(); return true;
     case 5:   // ok
       Sc = 6; Cc = 0; CN = 0; CY = 0; return true;
     case 6:   // send!N
@@ -199,10 +221,10 @@ bool fire_transition( unsigned tr ){
   else if( tr == 2 ){
     switch( Rc ){
     case 0:
-      if( !Dc[0] ){ return false; }
-      if( Dc[0] < 3 && Db[0] == Rb ){ Rm = Dc[0]-1; Rc = 1; }
-      else{ Rb = Db[0]; Rc = 2; }
-      Dc[0] = 0; Db[0] = 0; cmprD(); return true;
+      if( !dc(0) ){ return false; }
+      if( dc(0) < 3 && db(0) == Rb ){ Rm = dc(0)-1; Rc = 1; }
+      else{ Rb = db(0); Rc = 2; }
+      d_rec(); return true;
     case 1:
       #ifdef check_out
       if( ( CN && !Rm ) || ( CY && Rm ) ){ CN = 0; CY = 0; }
@@ -211,8 +233,8 @@ bool fire_transition( unsigned tr ){
       #endif
       Rc = 2; Rm = 0; return true;
     case 2:
-      if( Ac[n-1] ){ return false; }
-      Ac[n-1] = 1; Ab[n-1] = Rb; cmprA(); Rc = 0; Rb = !Rb; return true;
+      if( !a_send( Rb ) ){ return false; }
+      Rc = 0; Rb = !Rb; return true;
     default:
       return false;
     }
@@ -220,30 +242,38 @@ bool fire_transition( unsigned tr ){
 
   /* Data loser */
   else if( tr == 3 ){
-    if( !Dc[0] ){ return false; }
-    Dc[0] = 0; Db[0] = 0; cmprD(); return true;
+    if( !dc(0) ){ return false; }
+    d_rec(); return true;
   }
 
   /* Ack loser */
   else if( tr == 4 ){
-    if( !Ac[0] ){ return false; }
-    Ac[0] = 0; Ab[0] = 0; cmprA(); return true;
+    if( !ac(0) ){ return false; }
+    a_rec(); return true;
   }
 
-  /* Data channel */
+  /* Data channel (atomic channels have no transitions of their own) */
   else if( tr < n+4 ){
+    #ifdef compress
+    return false;
+    #else
     tr -= 4;
     if( !Dc[ tr ] || Dc[ tr-1 ] ){ return false; }
     Dc[ tr-1 ] = Dc[ tr ]; Dc[ tr ] = 0; Db[ tr-1 ] = Db[ tr ]; Db[ tr ] = 0;
     return true;
+    #endif
   }
 
   /* Ack channel */
   else if( tr < 2*n+3 ){
+    #ifdef compress
+    return false;
+    #else
     tr -= n+3;
     if( !Ac[ tr ] || Ac[ tr-1 ] ){ return false; }
     Ac[ tr-1 ] = Ac[ tr ]; Ac[ tr ] = 0; Ab[ tr-1 ] = Ab[ tr ]; Ab[ tr ] = 0;
     return true;
+    #endif
   }
 
   #ifdef terminate
@@ -257,6 +287,59 @@ bool fire_transition( unsigned tr ){
   return false;
 }
 
+/* The variables that each transition reads or writes, for tr_cache and
+  symbolic */
+#define tr_vars
+void transition_vars( unsigned tr ){
+  if( tr < 2 ){                 // Sender, and Client if check_out
+    wr( Sc ); wr( Sm ); wr( Cc ); wr( CN ); wr( CY );
+    if( tr == 0 ){
+      wr( Sb );
+      #ifdef compress
+      wr( D ); wr( A );
+      #else
+      wr( Dc[n-1] ); wr( Db[n-1] ); wr( Ac[0] ); wr( Ab[0] );
+      #endif
+    }
+  }
+  else if( tr == 2 ){           // Receiver, and Client if check_out
+    wr( Rc ); wr( Rm ); wr( Rb ); wr( Cc ); wr( CN ); wr( CY );
+    #ifdef compress
+    wr( D ); wr( A );
+    #else
+    wr( Dc[0] ); wr( Db[0] ); wr( Ac[n-1] ); wr( Ab[n-1] );
+    #endif
+  }
+  else if( tr < 5 ){            // losers
+    #ifdef compress
+    if( tr == 3 ){ wr( D ); }else{ wr( A ); }
+    #else
+    if( tr == 3 ){ wr( Dc[0] ); wr( Db[0] ); }
+    else{ wr( Ac[0] ); wr( Ab[0] ); }
+    #endif
+  }
+  else if( tr < 2*n+3 ){        // channel cells
+    #ifndef compress
+    if( tr < n+4 ){
+      tr -= 4; wr( Dc[tr] ); wr( Dc[tr-1] ); wr( Db[tr] ); wr( Db[tr-1] );
+    }else{
+      tr -= n+3; wr( Ac[tr] ); wr( Ac[tr-1] ); wr( Ab[tr] ); wr( Ab[tr-1] );
+    }
+    #endif
+  }
+  else{                         // Stopper
+    wr( Sc ); wr( Sb );
+  }
+}
+
+/* The variables that check_state reads, for symbolic */
+#define state_vars
+void check_state_vars(){
+  #ifdef check_out
+  rd( Rc ); rd( Rm ); rd( Cc ); rd( CN ); rd( CY );
+  #endif
+}
+
 void next_stubborn( unsigned tr ){
 
   if( tr == 0 ){
@@ -268,10 +351,10 @@ void next_stubborn( unsigned tr ){
       stb(1,2); return;
       #endif
     case 1: case 3:
-      if( Dc[n-1] ){ if( chn ){ stb(n+3); }else{ stb(2,3); } }
+      if( dc(n-1) ){ if( chn ){ stb(n+3); }else{ stb(2,3); } }
       return;
     case 2: case 4:
-      if( Ac[0] ){ stb(1,4); }
+      if( ac(0) ){ stb(1,4); }
       else if( chn ){ stb(n+4); }else{ stb(2); }
       return;
     case 5:
@@ -292,38 +375,38 @@ void next_stubborn( unsigned tr ){
   else if( tr == 2 ){
     switch( Rc ){
     case 0:
-      if( Dc[0] ){ stb(3); }
+      if( dc(0) ){ stb(3); }
       else if( chn ){ stb(5); }else{ stb(0); }
       return;
     case 1:
       stb(0,1); return;
     case 2:
-      if( Ac[n-1] ){ if( chn ){ stb(2*n+2); }else{ stb(0,4); } }
+      if( ac(n-1) ){ if( chn ){ stb(2*n+2); }else{ stb(0,4); } }
       return;
     }
   }
 
   else if( tr == 3 ){
-    if( Dc[0] ){ stb(2); }
+    if( dc(0) ){ stb(2); }
     else if( chn ){ stb(5); }else{ stb(0); }
     return;
   }
 
   else if( tr == 4 ){
-    if( Ac[0] ){ stb(0); }
+    if( ac(0) ){ stb(0); }
     else if( chn ){ stb(n+4); }else{ stb(2); }
     return;
   }
 
   else if( tr < n+4 ){
-    if( !Dc[ tr-4 ] ){ if( tr < n+3 ){ stb(tr+1); }else{ stb(0); } }
-    else if( Dc[ tr-5 ] ){ if( tr > 5 ){ stb(tr-1); }else{ stb(2,3); } }
+    if( !dc( tr-4 ) ){ if( tr < n+3 ){ stb(tr+1); }else{ stb(0); } }
+    else if( dc( tr-5 ) ){ if( tr > 5 ){ stb(tr-1); }else{ stb(2,3); } }
     return;
   }
 
   else if( tr < 2*n+3 ){
-    if( !Ac[ tr-n-3 ] ){ if( tr < 2*n+2 ){ stb(tr+1); }else{ stb(2); } }
-    else if( Ac[ tr-n-4 ] ){ if( tr > n+4 ){ stb(tr-1); }else{ stb(0,4); } }
+    if( !ac( tr-n-3 ) ){ if( tr < 2*n+2 ){ stb(tr+1); }else{ stb(2); } }
+    else if( ac( tr-n-4 ) ){ if( tr > n+4 ){ stb(tr-1); }else{ stb(0,4); } }
     return;
   }
 
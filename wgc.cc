@@ -6,7 +6,8 @@ wolf and the sheep together unattended, because otherwise the wolf eats the
 sheep. The same applies to the sheep and the cabbage. How can the man get all
 three safely to the opposite side of the river?
 
-Try this also with the option try_forward.
+Try this also with the options try_forward, best_first, beam_width, and
+bidirectional.
 
 Antti Valmari 2014-10-14 */
 
@@ -42,6 +43,12 @@ const char *check_state(){
   return "All on the right bank!";
 }
 
+/* For best_first, a_star, and beam_width: how far from all on the right bank */
+#define heuristic
+unsigned distance(){
+  return ( 2 - wolf % 3 ) + ( 2 - sheep % 3 ) + ( 2 - cabb % 3 );
+}
+
 /* From left bank to boat, from boat to right bank and so on. */
 void move( state_var &xx ){
   if( xx < 3 ){ ++xx; }else{ xx = 0; }
@@ -89,3 +96,38 @@ bool fire_transition( unsigned tr ){
   return false;
 }
 
+/* For bidirectional: the transitions backwards, and the goal states. Because
+each transition keeps the conditions that it tests, they are tested after it
+in the same way as before it. */
+#define backward
+void unmove( state_var &xx ){
+  if( xx > 0 ){ --xx; }else{ xx = 3; }
+}
+bool fire_backward( unsigned tr ){
+  switch( tr ){
+  case 0:
+    if(
+      wolf != sheep && sheep != cabb &&
+      !(wolf % 2) && !(sheep % 2) && !(cabb % 2)
+    ){
+      unmove( man ); return true;
+    }return false;
+  case 1:
+    if( man == wolf && sheep != cabb ){
+      unmove( man ); unmove( wolf ); return true;
+    }return false;
+  case 2:
+    if( man == sheep ){
+      unmove( man ); unmove( sheep ); return true;
+    }return false;
+  case 3:
+    if( man == cabb && wolf != sheep ){
+      unmove( man ); unmove( cabb ); return true;
+    }return false;
+  }
+  return false;
+}
+bool next_goal( unsigned gi ){
+  if( gi > 3 ){ return false; }
+  man = gi; wolf = 2; sheep = 2; cabb = 2; return true;
+}